@@ -0,0 +1,99 @@
+// Host benchmark: cost of lighting the words for one clock frame.
+//
+// Compares the old path (String-style "HOUR_" + hour concatenation and a
+// strcmp walk over the word table for every word) with the WordId/LedMask
+// path used by ClockDisplayHAL today.
+//
+// Build & run from esp/wordclock:
+//   g++ -O2 -std=c++17 -Isrc bench/word_lookup_bench.cpp -o word_lookup_bench && ./word_lookup_bench
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "WordLayout.h"
+
+static uint32_t framebuffer[LedMask::NUM_BITS];
+
+// Old ClockDisplayHAL::displayWord: linear search by name, then fill the span
+static void displayWordByName(const std::string &word, uint32_t color)
+{
+    for (const WordSpan &mapping : WORD_SPANS)
+    {
+        if (word == mapping.word)
+        {
+            for (uint8_t i = mapping.start; i <= mapping.end; ++i)
+            {
+                framebuffer[i] = color;
+            }
+            break;
+        }
+    }
+}
+
+// New ClockDisplayHAL::blitMask
+static void blitMask(const LedMask &mask, uint32_t color)
+{
+    for (uint8_t w = 0; w < LedMask::NUM_WORDS; w++)
+    {
+        uint32_t bits = mask.bits[w];
+        while (bits)
+        {
+            framebuffer[w * 32 + __builtin_ctz(bits)] = color;
+            bits &= bits - 1;
+        }
+    }
+}
+
+static void frameByName(int hour, uint32_t color)
+{
+    displayWordByName("IT", color);
+    displayWordByName("IS", color);
+    displayWordByName("PAST", color);
+    displayWordByName("MINUTES", color);
+    displayWordByName("TWENTYFIVE", color);
+    std::string hourWord = "HOUR_" + std::to_string(hour);
+    displayWordByName(hourWord, color);
+}
+
+static void frameByMask(int hour, uint32_t color)
+{
+    blitMask(WORD_MASKS[WORD_IT], color);
+    blitMask(WORD_MASKS[WORD_IS], color);
+    blitMask(WORD_MASKS[WORD_PAST], color);
+    blitMask(WORD_MASKS[WORD_MINUTES], color);
+    blitMask(WORD_MASKS[WORD_TWENTYFIVE], color);
+    blitMask(WORD_MASKS[hourWord(hour)], color);
+}
+
+template <typename F>
+static double nsPerFrame(F frame, long iterations)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++)
+    {
+        frame((int)(i % 12) + 1, (uint32_t)i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+int main()
+{
+    const long iterations = 2000000;
+
+    double byName = nsPerFrame(frameByName, iterations);
+    double byMask = nsPerFrame(frameByMask, iterations);
+
+    uint32_t checksum = 0;
+    for (uint32_t px : framebuffer)
+    {
+        checksum ^= px;
+    }
+
+    printf("frame via name lookup: %8.1f ns\n", byName);
+    printf("frame via word masks : %8.1f ns\n", byMask);
+    printf("speedup              : %8.1fx\n", byName / byMask);
+    printf("(checksum %08x)\n", checksum);
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include "AnimationStore.h"
+#include "SerialHelper.h"
+
+static const time_t MIN_VALID_EPOCH = 1483228800; // 2017-01-01, same cut-off as WordClock
+
+const char *AnimationStore::PATH = "/hourly.gif";
+
+AnimationStore::AnimationStore() : lastCheckEpoch(0), retryAtMs(0), failed(false) {}
+
+void AnimationStore::begin()
+{
+    preferences.begin("gif", true); // Read-only
+    url = preferences.getString("url", "");
+    etag = preferences.getString("etag", "");
+    lastModified = preferences.getString("modified", "");
+    lastCheckEpoch = (time_t)preferences.getULong("checked", 0);
+    preferences.end();
+}
+
+bool AnimationStore::isDue()
+{
+    if (failed && (long)(millis() - retryAtMs) < 0)
+    {
+        return false;
+    }
+    if (!hasAnimation())
+    {
+        return true;
+    }
+    // Without the wall clock we cannot tell, and the copy on flash will do
+    time_t now = time(nullptr);
+    return now >= MIN_VALID_EPOCH && (now - lastCheckEpoch >= REVALIDATE_S || now < lastCheckEpoch);
+}
+
+AnimationStore::Result AnimationStore::fetch(const char *requestUrl)
+{
+    HTTPClient http;
+    http.begin(requestUrl);
+    bool conditional = hasAnimation() && url == requestUrl;
+    if (conditional && etag.length() > 0)
+    {
+        http.addHeader("If-None-Match", etag);
+    }
+    if (conditional && lastModified.length() > 0)
+    {
+        http.addHeader("If-Modified-Since", lastModified);
+    }
+    const char *headers[] = {"ETag", "Last-Modified"};
+    http.collectHeaders(headers, 2);
+
+    int httpResponseCode = http.GET();
+    Result result = FAILED;
+    if (httpResponseCode == HTTP_CODE_NOT_MODIFIED && conditional)
+    {
+        SERIAL_PRINTLN("GIF on flash is current");
+        if (http.header("ETag").length() > 0)
+        {
+            etag = http.header("ETag"); // Servers may refresh it with a 304
+        }
+        result = NOT_MODIFIED;
+    }
+    else if (httpResponseCode == HTTP_CODE_OK && download(http))
+    {
+        url = requestUrl;
+        etag = http.header("ETag");
+        lastModified = http.header("Last-Modified");
+        result = UPDATED;
+    }
+    else
+    {
+        SERIAL_PRINT("Failed to download GIF: ");
+        SERIAL_PRINTLN(String(httpResponseCode).c_str());
+    }
+    http.end();
+
+    failed = result == FAILED;
+    if (failed)
+    {
+        retryAtMs = millis() + RETRY_MS;
+        return result;
+    }
+    time_t now = time(nullptr);
+    lastCheckEpoch = now >= MIN_VALID_EPOCH ? now : 0;
+    saveValidators();
+    return result;
+}
+
+bool AnimationStore::download(HTTPClient &http)
+{
+    // The new copy is written next to the old one, so it has to fit in the
+    // space left beside it (a leftover from an interrupted transfer is
+    // dropped first). -1 means chunked, size unknown.
+    String tempPath = String(PATH) + ".tmp";
+    LittleFS.remove(tempPath);
+    int gifSize = http.getSize();
+    size_t freeBytes = LittleFS.totalBytes() - LittleFS.usedBytes();
+    if (gifSize > 0 && (size_t)gifSize > freeBytes)
+    {
+        SERIAL_PRINTLN("GIF does not fit on flash");
+        return false;
+    }
+
+    // Into a temporary file first, so a broken transfer keeps the old animation
+    File file = LittleFS.open(tempPath, FILE_WRITE);
+    if (!file)
+    {
+        SERIAL_PRINTLN("Cannot create GIF file on flash");
+        return false;
+    }
+    SERIAL_PRINTLN("Downloading GIF...");
+    int written = http.writeToStream(&file);
+    file.close();
+
+    if (written <= 0 || (gifSize > 0 && written != gifSize))
+    {
+        SERIAL_PRINT("GIF download incomplete: ");
+        SERIAL_PRINTLN(String(written).c_str());
+        LittleFS.remove(tempPath);
+        return false;
+    }
+    // Replaces the old file atomically, a power loss leaves one or the other
+    if (!LittleFS.rename(tempPath, PATH))
+    {
+        SERIAL_PRINTLN("Cannot store GIF on flash");
+        return false;
+    }
+
+    SERIAL_PRINT("GIF stored on flash: ");
+    SERIAL_PRINT(String(written).c_str());
+    SERIAL_PRINTLN(" bytes");
+    return true;
+}
+
+void AnimationStore::saveValidators()
+{
+    preferences.begin("gif", false);
+    preferences.putString("url", url);
+    preferences.putString("etag", etag);
+    preferences.putString("modified", lastModified);
+    preferences.putULong("checked", (unsigned long)lastCheckEpoch);
+    preferences.end();
+}
+
+void AnimationStore::clear()
+{
+    url = etag = lastModified = "";
+    lastCheckEpoch = 0;
+    preferences.begin("gif", false);
+    preferences.clear();
+    preferences.end();
+}
@@ -0,0 +1,47 @@
+#ifndef ANIMATION_STORE_H
+#define ANIMATION_STORE_H
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+
+// The hourly animation on LittleFS plus the validators its server sent (ETag,
+// Last-Modified, in NVS). Boots use the copy on flash; the server is asked
+// again only after a long interval, with a conditional request that normally
+// answers 304 without a body. A download replaces the file only when complete.
+class AnimationStore
+{
+public:
+    static const char *PATH;
+    static const time_t REVALIDATE_S = 24L * 3600; // Between checks with the server
+    static const unsigned long RETRY_MS = 15UL * 60 * 1000; // After a failed request
+
+    enum Result
+    {
+        UPDATED,      // New file on flash
+        NOT_MODIFIED, // Copy on flash is current
+        FAILED
+    };
+
+    AnimationStore();
+    void begin(); // Loads the validators; LittleFS must be mounted
+    bool hasAnimation() { return LittleFS.exists(PATH); }
+    bool isDue(); // Nothing on flash, or the last check is REVALIDATE_S old
+    Result fetch(const char *url); // Network task only
+    void clear(); // Forgets the validators, the next fetch downloads in full
+
+private:
+    Preferences preferences;
+    String url; // Validators below belong to this URL
+    String etag;
+    String lastModified;
+    time_t lastCheckEpoch; // Wall clock of the last answer from the server
+    unsigned long retryAtMs;
+    bool failed;
+
+    bool download(HTTPClient &http);
+    void saveValidators();
+};
+
+#endif
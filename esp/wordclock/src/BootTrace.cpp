@@ -0,0 +1,47 @@
+#include "BootTrace.h"
+#include "SerialHelper.h"
+
+BootTrace::Phase BootTrace::phases[BootTrace::MAX_PHASES];
+uint8_t BootTrace::phaseCount = 0;
+portMUX_TYPE BootTrace::lock = portMUX_INITIALIZER_UNLOCKED;
+
+void BootTrace::mark(const char *phase)
+{
+    unsigned long now = millis();
+    bool added = false;
+
+    portENTER_CRITICAL(&lock);
+    bool seen = false;
+    for (uint8_t i = 0; i < phaseCount && !seen; i++)
+    {
+        seen = strcmp(phases[i].name, phase) == 0;
+    }
+    if (!seen && phaseCount < MAX_PHASES)
+    {
+        phases[phaseCount].name = phase;
+        phases[phaseCount].atMs = now;
+        phaseCount++;
+        added = true;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (added)
+    {
+        SERIAL_PRINT("[boot] ");
+        SERIAL_PRINT(String(now).c_str());
+        SERIAL_PRINT(" ms: ");
+        SERIAL_PRINTLN(phase);
+    }
+}
+
+void BootTrace::print()
+{
+    SERIAL_PRINTLN("Boot trace (ms since start-up):");
+    for (uint8_t i = 0; i < phaseCount; i++)
+    {
+        SERIAL_PRINT("  ");
+        SERIAL_PRINT(String(phases[i].atMs).c_str());
+        SERIAL_PRINT("  ");
+        SERIAL_PRINTLN(phases[i].name);
+    }
+}
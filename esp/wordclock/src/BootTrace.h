@@ -0,0 +1,28 @@
+#ifndef BOOT_TRACE_H
+#define BOOT_TRACE_H
+
+#include <Arduino.h>
+
+// Milliseconds since start-up at which each boot phase was first reached,
+// logged as it happens to track time-to-first-frame. Safe from both tasks.
+class BootTrace
+{
+public:
+    static const uint8_t MAX_PHASES = 12;
+
+    static void mark(const char *phase); // Only the first mark per phase counts
+    static void print();
+
+private:
+    struct Phase
+    {
+        const char *name;
+        unsigned long atMs;
+    };
+
+    static Phase phases[MAX_PHASES];
+    static uint8_t phaseCount;
+    static portMUX_TYPE lock;
+};
+
+#endif
@@ -1,32 +1,13 @@
 #include "ClockDisplayHAL.h"
 #include "esp_task_wdt.h"
 #include "SerialHelper.h"
-
-ClockDisplayHAL::WordMapping const ClockDisplayHAL::WORDS_TO_LEDS[] = {
-    {"HOUR_1", 20, 22},
-    {"HOUR_2", 45, 47},
-    {"HOUR_3", 15, 19},
-    {"HOUR_4", 67, 70},
-    {"HOUR_5", 40, 43},
-    {"HOUR_6", 12, 14},
-    {"HOUR_7", 55, 59},
-    {"HOUR_8", 31, 35},
-    {"HOUR_9", 36, 39},
-    {"HOUR_10", 9, 11},
-    {"HOUR_11", 24, 29},
-    {"HOUR_12", 48, 53},
-    {"OCLOCK", 0, 5},
-    {"PAST", 60, 63},
-    {"TO", 63, 64},
-    {"MINUTES", 77, 83},
-    {"THIRTY", 84, 89},
-    {"TWENTY", 102, 107},
-    {"TWENTYFIVE", 98, 107},
-    {"FIVE", 98, 101},
-    {"TEN", 91, 93},
-    {"FIFTEEN", 110, 116},
-    {"IS", 127, 128},
-    {"IT", 130, 131}};
+#if defined(WORDCLOCK_NATIVE)
+#include "native/SimOutput.h"
+#elif LED_OUTPUT_RMT
+#include "RmtOutput.h"
+#else
+#include "NeoPixelOutput.h"
+#endif
 
 const uint32_t ClockDisplayHAL::COLORS[] = {
     0xFF0000, // Red
@@ -41,7 +22,19 @@ const uint32_t ClockDisplayHAL::COLORS[] = {
 
 const int ClockDisplayHAL::getWordCount()
 {
-    return sizeof(WORDS_TO_LEDS) / sizeof(WORDS_TO_LEDS[0]);
+    return WORD_COUNT;
+}
+
+WordId ClockDisplayHAL::findWord(const char *word)
+{
+    for (uint8_t i = 0; i < WORD_COUNT; i++)
+    {
+        if (strcmp(word, WORDS_TO_LEDS[i].word) == 0)
+        {
+            return (WordId)i;
+        }
+    }
+    return WORD_COUNT;
 }
 
 const int ClockDisplayHAL::getColorCount()
@@ -50,119 +43,270 @@ const int ClockDisplayHAL::getColorCount()
 }
 
 ClockDisplayHAL::ClockDisplayHAL(uint8_t pin, uint8_t brightness)
-    : pixels(NUM_LEDS, pin, NEO_GRB + NEO_KHZ800), brightness(brightness)
+    : frameBuffers(), front(frameBuffers[0]), back(frameBuffers[1]), bufferLock(portMUX_INITIALIZER_UNLOCKED),
+      brightness(brightness), dirty(false), ledTestStep(0)
+{
+#if defined(WORDCLOCK_NATIVE)
+    (void)pin; // The simulator has no data pin
+    output = new SimOutput();
+#elif LED_OUTPUT_RMT
+    output = new RmtOutput(pin, NUM_LEDS);
+#else
+    output = new NeoPixelOutput(pin, NUM_LEDS);
+#endif
+}
+
+void ClockDisplayHAL::setOutput(LedOutput *newOutput)
 {
+    delete output;
+    output = newOutput;
 }
 
 void ClockDisplayHAL::setup()
 {
-    pixels.setBrightness(255);
-    pixels.begin();
-    pixels.show();
+    output->begin();
+    output->write(front, NUM_LEDS);
+    dirty = false;
+    SERIAL_PRINT("LED output: ");
+    SERIAL_PRINTLN(output->getName());
+}
+
+uint32_t ClockDisplayHAL::Color(uint8_t r, uint8_t g, uint8_t b)
+{
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+uint32_t ClockDisplayHAL::ColorHSV(uint16_t hue, uint8_t sat, uint8_t val)
+{
+    // Six 60-degree sectors around the wheel; same hue range as Adafruit_NeoPixel::ColorHSV
+    uint32_t scaled = (uint32_t)hue * 6;
+    uint8_t sector = scaled >> 16;
+    uint16_t fraction = scaled & 0xFFFF;
+
+    uint8_t p = (val * (255 - sat)) / 255;
+    uint8_t q = (val * (255 - ((sat * (uint32_t)fraction) >> 16))) / 255;
+    uint8_t t = (val * (255 - ((sat * (uint32_t)(0xFFFF - fraction)) >> 16))) / 255;
+
+    switch (sector)
+    {
+    case 0:
+        return Color(val, t, p);
+    case 1:
+        return Color(q, val, p);
+    case 2:
+        return Color(p, val, t);
+    case 3:
+        return Color(p, q, val);
+    case 4:
+        return Color(t, p, val);
+    default:
+        return Color(val, p, q);
+    }
+}
+
+void ClockDisplayHAL::displayWord(WordId word, uint32_t color)
+{
+    if (word < WORD_COUNT)
+    {
+        blitMask(WORD_MASKS[word], color);
+    }
 }
 
 void ClockDisplayHAL::displayWord(const String &word, uint32_t color)
 {
-    for (auto mapping : WORDS_TO_LEDS)
+    displayWord(findWord(word.c_str()), color);
+}
+
+void ClockDisplayHAL::blitMask(const LedMask &mask, uint32_t color)
+{
+    for (uint8_t w = 0; w < LedMask::NUM_WORDS; w++)
     {
-        if (word.equals(mapping.word))
+        uint32_t bits = mask.bits[w];
+        while (bits)
         {
-            for (uint8_t i = mapping.start; i <= mapping.end; ++i)
-            {
-                pixels.setPixelColor(i, color);
-            }
-            break;
+            uint8_t bit = __builtin_ctz(bits);
+            back[w * 32 + bit] = color;
+            bits &= bits - 1; // Clear lowest set bit
         }
     }
+    dirty = true;
+}
+
+void ClockDisplayHAL::setPixel(uint8_t x, uint8_t y, uint32_t color)
+{
+    if (x >= WIDTH || y >= HEIGHT)
+    {
+        return;
+    }
+    back[STRIP_INDEX.index[y][x]] = color;
+    dirty = true;
 }
 
-uint16_t ClockDisplayHAL::cartesianToWordClockLEDStripIndex(uint8_t x, uint8_t y)
+uint32_t ClockDisplayHAL::getPixel(uint8_t x, uint8_t y)
 {
-    uint16_t row_index;
-    uint16_t index;
+    if (x >= WIDTH || y >= HEIGHT)
+    {
+        return 0;
+    }
+    return back[STRIP_INDEX.index[y][x]];
+}
 
-    if (y % 2 == 0)
+void ClockDisplayHAL::blitRow(uint8_t y, const uint32_t *row, uint8_t x, uint8_t width)
+{
+    if (y >= HEIGHT || x >= WIDTH)
     {
-        row_index = NUM_LEDS - (y * WIDTH);
-        index = row_index - (x + 1);
+        return;
     }
-    else
+    if (width > WIDTH - x)
     {
-        row_index = NUM_LEDS - ((y + 1) * WIDTH);
-        index = row_index + x;
+        width = WIDTH - x;
     }
 
-    if (index < 0 || index >= NUM_LEDS)
+    const uint8_t *indices = &STRIP_INDEX.index[y][x];
+    for (uint8_t i = 0; i < width; i++)
     {
-        return 0;
+        back[indices[i]] = row[i];
+    }
+    dirty = true;
+}
+
+void ClockDisplayHAL::blitRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, const uint32_t *pixels)
+{
+    if (y >= HEIGHT)
+    {
+        return;
+    }
+    if (height > HEIGHT - y)
+    {
+        height = HEIGHT - y;
     }
 
-    return index;
+    for (uint8_t row = 0; row < height; row++)
+    {
+        blitRow(y + row, pixels + row * width, x, width);
+    }
 }
 
-void ClockDisplayHAL::setPixel(uint8_t x, uint8_t y, uint32_t color)
+void ClockDisplayHAL::fill(uint32_t color)
 {
-    uint16_t index = cartesianToWordClockLEDStripIndex(x, y);
-    pixels.setPixelColor(index, color);
+    for (uint16_t i = 0; i < NUM_LEDS; i++)
+    {
+        back[i] = color;
+    }
+    dirty = true;
 }
 
-void ClockDisplayHAL::clearPixels(bool show)
+void ClockDisplayHAL::clearPixels(bool present)
 {
-    pixels.clear();
-    if (show)
+    memset(back, 0, NUM_LEDS * sizeof(uint32_t));
+    dirty = true;
+    if (present)
     {
-        pixels.show();
+        this->present();
     }
 }
 
-void ClockDisplayHAL::show()
+void ClockDisplayHAL::present()
 {
-    pixels.show();
+    if (!dirty)
+    {
+        return;
+    }
+    dirty = false;
+
+    if (memcmp(back, front, NUM_LEDS * sizeof(uint32_t)) == 0)
+    {
+        return; // Same pixels as already displayed
+    }
+
+    portENTER_CRITICAL(&bufferLock);
+    uint32_t *finished = back;
+    back = front;
+    front = finished;
+    portEXIT_CRITICAL(&bufferLock);
+
+    // Renderers draw incrementally (GIF frames, tests), so start the next frame from this one
+    memcpy(back, front, NUM_LEDS * sizeof(uint32_t));
+    output->write(front, NUM_LEDS);
 }
 
-void ClockDisplayHAL::runLedTest(bool (*shouldAbort)())
+void ClockDisplayHAL::beginLedTest()
+{
+    ledTestStep = 0;
+}
+
+bool ClockDisplayHAL::stepLedTest()
 {
     // Test all LEDs row by row, cycling through colors (use shared color palette)
     int numColors = getColorCount();
-    
-    // Cycle through each row
-    for (uint8_t row = 0; row < HEIGHT; row++)
+    if (ledTestStep >= HEIGHT * numColors)
+    {
+        clearPixels(true);
+        return false;
+    }
+
+    uint8_t row = ledTestStep / numColors;
+    int colorIndex = ledTestStep % numColors;
+    ledTestStep++;
+
+    // Light up entire row with current color
+    uint32_t rowPixels[WIDTH];
+    for (uint8_t col = 0; col < WIDTH; col++)
     {
-        // Check if test should abort
-        if (shouldAbort && shouldAbort())
+        rowPixels[col] = COLORS[colorIndex];
+    }
+    clearPixels(false);
+    blitRow(row, rowPixels);
+    present();
+    return true;
+}
+
+void ClockDisplayHAL::benchmarkOutput(uint16_t frames)
+{
+    // Time present() blocks the caller per frame, and how much of it runs with
+    // interrupts masked at most (all of NeoPixel show(); the RMT backend never masks them)
+    uint32_t total = 0;
+    uint32_t worst = 0;
+    uint32_t irqOffTotal = 0;
+    uint32_t irqOffWorst = 0;
+
+    for (uint16_t i = 0; i < frames; i++)
+    {
+        fill(COLORS[i % getColorCount()]);
+
+        uint32_t start = micros();
+        present();
+        uint32_t elapsed = micros() - start;
+
+        uint32_t irqOff = output->getInterruptsOffUs();
+
+        total += elapsed;
+        if (elapsed > worst)
         {
-            SERIAL_PRINTLN("LED test aborted by user");
-            clearPixels(true);
-            return;
+            worst = elapsed;
         }
-        
-        esp_task_wdt_reset(); // Feed watchdog at start of each row
-        
-        // Cycle through colors for this row
-        for (int colorIndex = 0; colorIndex < numColors; colorIndex++)
+        irqOffTotal += irqOff;
+        if (irqOff > irqOffWorst)
         {
-            // Check if test should abort
-            if (shouldAbort && shouldAbort())
-            {
-                SERIAL_PRINTLN("LED test aborted by user");
-                clearPixels(true);
-                return;
-            }
-            
-            clearPixels(false);
-            
-            // Light up entire row with current color
-            for (uint8_t col = 0; col < WIDTH; col++)
-            {
-                setPixel(col, row, COLORS[colorIndex]);
-            }
-            
-            show();
-            delay(200); // Show each color for 200ms
+            irqOffWorst = irqOff;
         }
+        delay(20);
+        esp_task_wdt_reset();
     }
-    
-    // Clear at the end
+
     clearPixels(true);
-    esp_task_wdt_reset(); // Feed watchdog at end of test
-}
\ No newline at end of file
+
+    SERIAL_PRINT("LED output benchmark (");
+    SERIAL_PRINT(output->getName());
+    SERIAL_PRINT("): avg ");
+    SERIAL_PRINT(String(frames ? total / frames : 0).c_str());
+    SERIAL_PRINT(" us, max ");
+    SERIAL_PRINT(String(worst).c_str());
+    SERIAL_PRINT(" us in present(); interrupts off at most avg ");
+    SERIAL_PRINT(String(frames ? irqOffTotal / frames : 0).c_str());
+    SERIAL_PRINT(" us, max ");
+    SERIAL_PRINT(String(irqOffWorst).c_str());
+    SERIAL_PRINT(" us per frame over ");
+    SERIAL_PRINT(String(frames).c_str());
+    SERIAL_PRINTLN(" frames");
+}
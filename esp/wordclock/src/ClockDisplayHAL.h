@@ -1,7 +1,17 @@
 #ifndef CLOCKDISPLAYHAL_H
 #define CLOCKDISPLAYHAL_H
 
-#include <Adafruit_NeoPixel.h>
+#include <Arduino.h>
+#include "config.h"
+#include "LedOutput.h"
+#include "WordLayout.h"
+
+#ifndef LED_OUTPUT_RMT
+#define LED_OUTPUT_RMT 1 // 1 = non-blocking RMT output, 0 = Adafruit NeoPixel
+#endif
+#ifndef LED_OUTPUT_BENCHMARK
+#define LED_OUTPUT_BENCHMARK 0 // Run ClockDisplayHAL::benchmarkOutput() at boot
+#endif
 
 class ClockDisplayHAL
 {
@@ -11,34 +21,57 @@ public:
     static const uint16_t NUM_LEDS = WIDTH * HEIGHT;
 
     ClockDisplayHAL(uint8_t pin, uint8_t brightness);
-    Adafruit_NeoPixel pixels;
+    void setOutput(LedOutput *output); // Replace the default backend, call before setup()
     void setup();
-    void displayWord(const String &word, uint32_t color);
+    void displayWord(WordId word, uint32_t color);
+    void displayWord(const String &word, uint32_t color); // Name lookup, for web/test paths
+    void blitMask(const LedMask &mask, uint32_t color);   // Set every LED in mask to color
     void setPixel(uint8_t x, uint8_t y, uint32_t color);
-    void clearPixels(bool show = true);
-    void show();
+    uint32_t getPixel(uint8_t x, uint8_t y);
+    
+    // Copy a run of pixels into row y starting at column x (clipped to the grid)
+    void blitRow(uint8_t y, const uint32_t *row, uint8_t x = 0, uint8_t width = WIDTH);
+    // Copy a width x height block, row-major, with its top-left corner at (x, y)
+    void blitRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, const uint32_t *pixels);
+    void fill(uint32_t color);
+    void clearPixels(bool present = true);
+    
+    // All drawing goes to the back buffer; present() swaps it to the front and sends
+    // the front buffer to the LEDs. Skipped when the frame matches what is displayed.
+    void present();
     
-    // Test functions
-    void runLedTest(bool (*shouldAbort)() = nullptr); // Optional abort check callback
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b);
+    static uint32_t ColorHSV(uint16_t hue, uint8_t sat = 255, uint8_t val = 255); // hue 0-65535
     
-    // Word mapping structure and access
-    struct WordMapping
-    {
-        const char *word;
-        uint8_t start;
-        uint8_t end;
-    };
+    // LED test: every row in every palette color, one step per call
+    static const unsigned long LED_TEST_STEP_MS = 200;
+    void beginLedTest();
+    bool stepLedTest(); // Returns false (and clears) once the sweep is complete
+    void benchmarkOutput(uint16_t frames);             // Logs present() time and interrupts-off time per frame
     
-    static const WordMapping WORDS_TO_LEDS[];
+    // Word mapping structure and access (tables live in WordLayout.h)
+    typedef WordSpan WordMapping;
+    
+    static constexpr const WordMapping *WORDS_TO_LEDS = WORD_SPANS;
     static const int getWordCount();
+    static WordId findWord(const char *word); // Returns WORD_COUNT if unknown
     
     // Standard color palette (DRY principle - shared across test functions)
     static const uint32_t COLORS[];
     static const int getColorCount();
 
 private:
+    static_assert(NUM_LEDS == LedMask::NUM_BITS, "LedMask size must match the LED strip");
+    static_assert(WIDTH == LAYOUT_WIDTH && HEIGHT == LAYOUT_HEIGHT, "STRIP_INDEX size must match the display");
+
+    LedOutput *output;
+    uint32_t frameBuffers[2][NUM_LEDS]; // 0xRRGGBB in strip order
+    uint32_t *front;                    // Last presented frame, only read by the output
+    uint32_t *back;                     // Frame being drawn
+    portMUX_TYPE bufferLock;
     uint8_t brightness;
-    uint16_t cartesianToWordClockLEDStripIndex(uint8_t x, uint8_t y);
+    bool dirty; // Back buffer written since the last present()
+    uint16_t ledTestStep;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef CLOCK_FRAMES_H
+#define CLOCK_FRAMES_H
+
+#include "WordLayout.h"
+
+// Every sentence the clock can show, generated at compile time.
+// Indexed by (hour % 12, minute / 5): 12 x 12 = 144 frames.
+
+static constexpr uint8_t CLOCK_SLOTS_PER_HOUR = 12;
+static constexpr uint8_t CLOCK_FRAME_COUNT = 12 * CLOCK_SLOTS_PER_HOUR;
+
+struct ClockFrame
+{
+    static constexpr uint8_t MAX_WORDS = 6; // IT IS PAST MINUTES TWENTYFIVE HOUR
+
+    LedMask mask;       // Union of all word masks
+    uint8_t wordCount;
+    WordId words[MAX_WORDS];
+
+    constexpr ClockFrame() : mask(), wordCount(0), words{} {}
+
+    constexpr void add(WordId word)
+    {
+        words[wordCount++] = word;
+        mask |= WORD_MASKS[word];
+    }
+};
+
+// Minute word for each five-minute slot
+inline constexpr WordId MINUTE_SLOT_WORDS[CLOCK_SLOTS_PER_HOUR] = {
+    WORD_OCLOCK, WORD_FIVE, WORD_TEN, WORD_FIFTEEN, WORD_TWENTY, WORD_TWENTYFIVE,
+    WORD_THIRTY, WORD_TWENTYFIVE, WORD_TWENTY, WORD_FIFTEEN, WORD_TEN, WORD_FIVE};
+
+constexpr uint8_t clockFrameIndex(int hour, int minute)
+{
+    return (uint8_t)((hour % 12) * CLOCK_SLOTS_PER_HOUR + minute / 5);
+}
+
+constexpr ClockFrame buildClockFrame(uint8_t index)
+{
+    int hour = index / CLOCK_SLOTS_PER_HOUR;
+    uint8_t slot = index % CLOCK_SLOTS_PER_HOUR;
+    if (hour == 0)
+        hour = 12;
+
+    ClockFrame frame;
+    frame.add(WORD_IT);
+    frame.add(WORD_IS);
+
+    if (slot == 0)
+    {
+        frame.add(WORD_OCLOCK);
+    }
+    else if (slot < 7) // Up to and including thirty: "PAST"
+    {
+        frame.add(WORD_PAST);
+        frame.add(WORD_MINUTES);
+        frame.add(MINUTE_SLOT_WORDS[slot]);
+    }
+    else // From thirty-five on: "TO" the next hour
+    {
+        frame.add(WORD_TO);
+        frame.add(WORD_MINUTES);
+        frame.add(MINUTE_SLOT_WORDS[slot]);
+        hour = hour % 12 + 1;
+    }
+
+    frame.add(hourWord(hour));
+    return frame;
+}
+
+struct ClockFrameTable
+{
+    ClockFrame frames[CLOCK_FRAME_COUNT];
+
+    constexpr const ClockFrame &operator[](uint8_t index) const
+    {
+        return frames[index];
+    }
+};
+
+constexpr ClockFrameTable buildClockFrames()
+{
+    ClockFrameTable table;
+    for (uint8_t i = 0; i < CLOCK_FRAME_COUNT; i++)
+    {
+        table.frames[i] = buildClockFrame(i);
+    }
+    return table;
+}
+
+inline constexpr ClockFrameTable CLOCK_FRAMES = buildClockFrames();
+
+static_assert(CLOCK_FRAMES[clockFrameIndex(12, 0)].words[3] == WORD_HOUR_12, "Noon must read TWELVE O'CLOCK");
+static_assert(CLOCK_FRAMES[clockFrameIndex(11, 35)].words[5] == WORD_HOUR_12, "11:35 must read TO TWELVE");
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef DISPLAY_COMMAND_H
+#define DISPLAY_COMMAND_H
+
+#include "MpscQueue.h"
+
+// Display actions requested from the web UI. Web handlers only post these;
+// the render task is the single consumer and the only code touching the display.
+enum DisplayCommand : uint8_t
+{
+    CMD_TRIGGER_GIF,
+    CMD_WORDS_TEST,
+    CMD_LED_TEST,
+    CMD_RESUME_NORMAL
+};
+
+class DisplayCommandQueue : public MpscQueue<DisplayCommand, 8>
+{
+public:
+    // onPost wakes the consumer so it does not have to poll
+    explicit DisplayCommandQueue(void (*onPost)() = nullptr) : onPost(onPost) {}
+
+    bool post(DisplayCommand command)
+    {
+        if (!push(command))
+            return false;
+        if (onPost)
+            onPost();
+        return true;
+    }
+
+private:
+    void (*onPost)();
+};
+
+#endif
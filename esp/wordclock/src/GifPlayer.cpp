@@ -1,86 +1,368 @@
 #include "GifPlayer.h"
+#include "SerialHelper.h"
 #define BRIGHT_SHIFT 0
 
 GifPlayer *GifPlayer::instance = nullptr;
 
 GifPlayer::GifPlayer(ClockDisplayHAL *clockDisplayHAL)
-    : clockDisplayHAL(clockDisplayHAL)
+    : clockDisplayHAL(clockDisplayHAL), animation(nullptr), playing(false), startMs(0), durationMs(0),
+      loopLimit(0), loopsDone(0), frameIndex(0), shownIndex(-1), frameDueMs(0), openFs(nullptr), canvas(nullptr), canvasWidth(0),
+      canvasHeight(0), frameDrawn(false), scaleMode(SCALE_LETTERBOX), srcX(0), srcY(0), srcWidth(0), srcHeight(0),
+      dstX(0), dstY(0), dstWidth(0), dstHeight(0)
 {
     gif.begin(GIF_PALETTE_RGB888);
     instance = this;
 }
 
+GifPlayer::~GifPlayer()
+{
+    delete animation;
+}
+
+void GifPlayer::setAnimation(GifAnimation *next)
+{
+    playing = false;
+    delete animation;
+    animation = next;
+}
+
+uint16_t GifPlayer::getFrameCount()
+{
+    return animation ? animation->frameCount : 0;
+}
+
+bool GifPlayer::loadGIF(fs::FS &fs, const char *path)
+{
+    setAnimation(decode(fs, path));
+    return animation != nullptr;
+}
+
 void GifPlayer::GIFDraw(GIFDRAW *pDraw)
 {
-    if (instance && instance->clockDisplayHAL)
+    if (!instance)
     {
-        ClockDisplayHAL *hal = instance->clockDisplayHAL;
+        return;
+    }
 
-        uint8_t r, g, b, *s, *p, *pPal = (uint8_t *)pDraw->pPalette;
-        int x, y = pDraw->iY + pDraw->y;
+    uint8_t *s = pDraw->pPixels, *p, *pPal = (uint8_t *)pDraw->pPalette;
+    int x, y = pDraw->iY + pDraw->y;
+    int width = pDraw->iWidth;
+    if (pDraw->iX + width > instance->canvasWidth)
+    {
+        width = instance->canvasWidth - pDraw->iX; // Clip once per scanline
+    }
+    instance->frameDrawn = true;
 
-        s = pDraw->pPixels;
-        if (pDraw->ucDisposalMethod == 2)
+    if (y < instance->canvasHeight && width > 0)
+    {
+        uint8_t *row = instance->canvas + ((size_t)y * instance->canvasWidth + pDraw->iX) * 3;
+        for (x = 0; x < width; x++, row += 3)
         {
-            p = &pPal[pDraw->ucBackground * 3];
-            r = p[0] >> BRIGHT_SHIFT;
-            g = p[1] >> BRIGHT_SHIFT;
-            b = p[2] >> BRIGHT_SHIFT;
-            for (x = 0; x < pDraw->iWidth; x++)
+            if (pDraw->ucHasTransparency && s[x] == pDraw->ucTransparent)
             {
-                if (s[x] == pDraw->ucTransparent)
-                {
-                    hal->setPixel(x, y, hal->pixels.Color(r, g, b));
-                }
+                // Transparent: background on disposal, otherwise keep the previous frame
+                if (pDraw->ucDisposalMethod != 2)
+                    continue;
+                p = &pPal[pDraw->ucBackground * 3];
             }
-            pDraw->ucHasTransparency = 0;
-        }
-
-        if (pDraw->ucHasTransparency)
-        {
-            const uint8_t ucTransparent = pDraw->ucTransparent;
-            for (x = 0; x < pDraw->iWidth; x++)
+            else
             {
-                if (s[x] != ucTransparent)
-                {
-                    p = &pPal[s[x] * 3];
-                    hal->setPixel(x, y, hal->pixels.Color(p[0] >> BRIGHT_SHIFT, p[1] >> BRIGHT_SHIFT, p[2] >> BRIGHT_SHIFT));
-                }
+                p = &pPal[s[x] * 3];
             }
+            row[0] = p[0] >> BRIGHT_SHIFT;
+            row[1] = p[1] >> BRIGHT_SHIFT;
+            row[2] = p[2] >> BRIGHT_SHIFT;
         }
+    }
+}
+
+void *GifPlayer::GIFOpen(const char *path, int32_t *size)
+{
+    if (!instance || !instance->openFs)
+    {
+        return nullptr;
+    }
+    File *file = new File(instance->openFs->open(path, FILE_READ));
+    if (!*file)
+    {
+        delete file;
+        return nullptr;
+    }
+    *size = (int32_t)file->size();
+    return file;
+}
+
+void GifPlayer::GIFClose(void *handle)
+{
+    File *file = static_cast<File *>(handle);
+    file->close();
+    delete file;
+}
+
+int32_t GifPlayer::GIFRead(GIFFILE *gifFile, uint8_t *buffer, int32_t length)
+{
+    File *file = static_cast<File *>(gifFile->fHandle);
+    if (length > gifFile->iSize - gifFile->iPos)
+    {
+        length = gifFile->iSize - gifFile->iPos;
+    }
+    if (length <= 0)
+    {
+        return 0;
+    }
+    int32_t count = (int32_t)file->read(buffer, length);
+    gifFile->iPos = (int32_t)file->position();
+    return count;
+}
+
+int32_t GifPlayer::GIFSeek(GIFFILE *gifFile, int32_t position)
+{
+    File *file = static_cast<File *>(gifFile->fHandle);
+    file->seek(position);
+    gifFile->iPos = (int32_t)file->position();
+    return gifFile->iPos;
+}
+
+GifAnimation *GifPlayer::decode(fs::FS &fs, const char *path)
+{
+    openFs = &fs;
+    int opened = gif.open(path, GIFOpen, GIFClose, GIFRead, GIFSeek, GIFDraw);
+    openFs = nullptr;
+    if (!opened)
+    {
+        SERIAL_PRINT("Cannot open GIF ");
+        SERIAL_PRINTLN(path);
+        return nullptr;
+    }
+
+    canvasWidth = gif.getCanvasWidth();
+    canvasHeight = gif.getCanvasHeight();
+    if (canvasWidth == 0 || canvasHeight == 0 || (uint32_t)canvasWidth * canvasHeight > MAX_CANVAS_PIXELS)
+    {
+        SERIAL_PRINT("GIF canvas too large: ");
+        SERIAL_PRINT(String(canvasWidth).c_str());
+        SERIAL_PRINT("x");
+        SERIAL_PRINTLN(String(canvasHeight).c_str());
+        gif.close();
+        return nullptr;
+    }
+
+    GifAnimation *decoded = new GifAnimation();
+    canvas = (uint8_t *)calloc((size_t)canvasWidth * canvasHeight, 3);
+    decoded->frames = (Frame *)malloc(sizeof(Frame) * MAX_FRAMES);
+    if (!canvas || !decoded->frames)
+    {
+        SERIAL_PRINTLN("Memory allocation failed for GIF frames");
+        free(canvas);
+        canvas = nullptr;
+        delete decoded;
+        gif.close();
+        return nullptr;
+    }
+    planScaling();
+
+    int rc;
+    do
+    {
+        int delayMs = 0;
+        frameDrawn = false;
+        rc = gif.playFrame(false, &delayMs);
+        if (rc < 0 || !frameDrawn)
+            break; // Decode error, or trailing data without an image
+
+        Frame &frame = decoded->frames[decoded->frameCount++];
+        scaleCanvas(frame);
+        // GIF delays go up to 655 s, more than a uint16_t of milliseconds holds
+        if (delayMs < 20)
+            frame.delayMs = DEFAULT_FRAME_DELAY_MS;
+        else
+            frame.delayMs = delayMs > UINT16_MAX ? UINT16_MAX : (uint16_t)delayMs;
+    } while (rc > 0 && decoded->frameCount < MAX_FRAMES);
+    gif.close();
+    free(canvas);
+    canvas = nullptr;
+
+    if (decoded->frameCount == 0)
+    {
+        delete decoded;
+        return nullptr;
+    }
+    Frame *shrunk = (Frame *)realloc(decoded->frames, sizeof(Frame) * decoded->frameCount);
+    if (shrunk)
+    {
+        decoded->frames = shrunk;
+    }
+
+    SERIAL_PRINT("GIF decoded from ");
+    SERIAL_PRINT(String(canvasWidth).c_str());
+    SERIAL_PRINT("x");
+    SERIAL_PRINT(String(canvasHeight).c_str());
+    SERIAL_PRINT(": ");
+    SERIAL_PRINT(String(decoded->frameCount).c_str());
+    SERIAL_PRINT(" frames, ");
+    SERIAL_PRINT(String(sizeof(Frame) * decoded->frameCount).c_str());
+    SERIAL_PRINTLN(" bytes");
+    return decoded;
+}
+
+// side * num / den rounded, at least one pixel
+static uint16_t scaledSide(uint32_t side, uint32_t num, uint32_t den)
+{
+    uint32_t scaled = (side * num + den / 2) / den;
+    return scaled > 0 ? scaled : 1;
+}
+
+static uint32_t overlap(uint32_t start, uint32_t end, uint32_t cellStart, uint32_t cellEnd)
+{
+    return (end < cellEnd ? end : cellEnd) - (start > cellStart ? start : cellStart);
+}
+
+void GifPlayer::planScaling()
+{
+    const uint16_t width = ClockDisplayHAL::WIDTH, height = ClockDisplayHAL::HEIGHT;
+    srcX = srcY = 0;
+    srcWidth = canvasWidth;
+    srcHeight = canvasHeight;
+    dstX = dstY = 0;
+    dstWidth = width;
+    dstHeight = height;
+
+    // Compare aspect ratios by cross-multiplying: wider than the display or not
+    bool wider = (uint32_t)canvasWidth * height > (uint32_t)canvasHeight * width;
+    if (scaleMode == SCALE_LETTERBOX)
+    {
+        if (wider)
+            dstHeight = scaledSide(canvasHeight, width, canvasWidth);
+        else
+            dstWidth = scaledSide(canvasWidth, height, canvasHeight);
+        dstX = (width - dstWidth) / 2;
+        dstY = (height - dstHeight) / 2;
+    }
+    else if (scaleMode == SCALE_CROP)
+    {
+        if (wider)
+            srcWidth = scaledSide(canvasHeight, width, height);
         else
+            srcHeight = scaledSide(canvasWidth, height, width);
+        srcX = (canvasWidth - srcWidth) / 2;
+        srcY = (canvasHeight - srcHeight) / 2;
+    }
+}
+
+// Area average in integers: output pixel o spans [o * src, (o + 1) * src) and
+// source pixel s spans [s * dst, (s + 1) * dst), both in units of 1/dst of a
+// source pixel, so every overlap is exact and the weights add up to src
+void GifPlayer::scaleCanvas(Frame &frame)
+{
+    memset(frame.rgb, 0, sizeof(frame.rgb)); // Letterbox bars stay black
+    const uint32_t area = (uint32_t)srcWidth * srcHeight;
+    for (uint16_t oy = 0; oy < dstHeight; oy++)
+    {
+        uint32_t top = (uint32_t)oy * srcHeight, bottom = top + srcHeight;
+        for (uint16_t ox = 0; ox < dstWidth; ox++)
         {
-            for (x = 0; x < pDraw->iWidth; x++)
+            uint32_t left = (uint32_t)ox * srcWidth, right = left + srcWidth;
+            uint32_t sum[3] = {0, 0, 0};
+            for (uint32_t sy = top / dstHeight; sy * dstHeight < bottom; sy++)
             {
-                p = &pPal[s[x] * 3];
-                hal->setPixel(x, y, hal->pixels.Color(p[0] >> BRIGHT_SHIFT, p[1] >> BRIGHT_SHIFT, p[2] >> BRIGHT_SHIFT));
+                uint32_t wy = overlap(top, bottom, sy * dstHeight, (sy + 1) * dstHeight);
+                uint32_t sx = left / dstWidth;
+                const uint8_t *p = canvas + ((size_t)(srcY + sy) * canvasWidth + srcX + sx) * 3;
+                for (; sx * dstWidth < right; sx++, p += 3)
+                {
+                    uint32_t w = wy * overlap(left, right, sx * dstWidth, (sx + 1) * dstWidth);
+                    sum[0] += p[0] * w;
+                    sum[1] += p[1] * w;
+                    sum[2] += p[2] * w;
+                }
             }
+            uint8_t *out = frame.rgb[dstY + oy][dstX + ox];
+            out[0] = (sum[0] + area / 2) / area;
+            out[1] = (sum[1] + area / 2) / area;
+            out[2] = (sum[2] + area / 2) / area;
         }
+    }
+}
 
-        if (pDraw->y == pDraw->iHeight - 1)
+void GifPlayer::showFrame(const Frame &frame)
+{
+    uint32_t row[ClockDisplayHAL::WIDTH];
+    for (uint8_t y = 0; y < ClockDisplayHAL::HEIGHT; y++)
+    {
+        const uint8_t *p = frame.rgb[y][0];
+        for (uint8_t x = 0; x < ClockDisplayHAL::WIDTH; x++, p += 3)
         {
-            hal->show();
+            row[x] = ClockDisplayHAL::Color(p[0], p[1], p[2]);
         }
+        clockDisplayHAL->blitRow(y, row);
     }
+    clockDisplayHAL->present();
 }
 
-bool GifPlayer::loadGIF(uint8_t *gifBuffer, size_t gifSize)
+bool GifPlayer::start(unsigned long duration, uint16_t loops)
 {
-    int rc = gif.open(gifBuffer, gifSize, GIFDraw);
-    return (rc != 0);
+    if (!animation || (duration == 0 && loops == 0))
+    {
+        return false;
+    }
+    playing = true;
+    startMs = millis();
+    durationMs = duration;
+    loopLimit = loops;
+    loopsDone = 0;
+    frameIndex = 0;
+    shownIndex = -1;
+    frameDueMs = startMs;
+    return true;
 }
 
-void GifPlayer::playGIF(unsigned long durationMs)
+void GifPlayer::stop()
 {
-    unsigned long startTime = millis();
+    playing = false;
+}
 
-    while (millis() - startTime < durationMs)
+unsigned long GifPlayer::tick()
+{
+    if (!playing)
     {
-        if (!gif.playFrame(true, nullptr))
+        return 0;
+    }
+
+    unsigned long now = millis();
+    if (durationMs > 0 && now - startMs >= durationMs)
+    {
+        playing = false;
+        return 0;
+    }
+
+    // Step over every frame whose delay ran out; a late tick skips frames
+    // rather than slowing the animation down
+    const Frame *frames = animation->frames;
+    const uint16_t frameCount = animation->frameCount;
+    while (now - frameDueMs >= frames[frameIndex].delayMs)
+    {
+        frameDueMs += frames[frameIndex].delayMs;
+        if (++frameIndex == frameCount)
         {
-            gif.reset();
+            frameIndex = 0;
+            if (loopLimit > 0 && ++loopsDone >= loopLimit)
+            {
+                playing = false;
+                return 0;
+            }
         }
     }
 
-    gif.close();
+    if (frameIndex != shownIndex)
+    {
+        showFrame(frames[frameIndex]);
+        shownIndex = frameIndex;
+    }
+
+    unsigned long untilNext = frames[frameIndex].delayMs - (now - frameDueMs);
+    if (durationMs > 0 && durationMs - (now - startMs) < untilNext)
+    {
+        untilNext = durationMs - (now - startMs);
+    }
+    return untilNext;
 }
@@ -3,21 +3,102 @@
 
 #include <Arduino.h>
 #include <AnimatedGIF.h>
+#include <FS.h>
 #include "ClockDisplayHAL.h"
 
+struct GifAnimation;
+
+// Decodes a GIF once into display-sized RGB frames, so playing it is only a
+// copy per frame and can be repeated without reopening the file. The GIF is
+// read from a file in small pieces, never held in RAM as a whole. Playback is
+// stepped by tick(): each call shows at most one frame and says when to call
+// again, so the caller's scheduler keeps running between frames. GIFs of
+// another size are area-averaged to the display while loading.
+//
+// decode() and playback share no state: one task can decode the next GIF
+// while another plays, and hand it over with setAnimation().
 class GifPlayer
 {
 public:
+    static const uint16_t MAX_FRAMES = 64;              // About 25 KB of cache
+    static const uint16_t DEFAULT_FRAME_DELAY_MS = 100; // For frames asking under 20 ms, like browsers do
+    static const uint32_t MAX_CANVAS_PIXELS = 128 * 128; // Decode buffer, 48 KB only while loading
+
+    enum ScaleMode
+    {
+        SCALE_STRETCH,   // Whole image, aspect ratio ignored
+        SCALE_LETTERBOX, // Whole image, black bars on the short side
+        SCALE_CROP       // Fills the display, centre cut out
+    };
+
+    struct Frame
+    {
+        uint8_t rgb[ClockDisplayHAL::HEIGHT][ClockDisplayHAL::WIDTH][3];
+        uint16_t delayMs;
+    };
+
     GifPlayer(ClockDisplayHAL *clockDisplayHAL);
-    bool loadGIF(uint8_t *gifBuffer, size_t gifSize);
-    void playGIF(unsigned long durationMs);
+    ~GifPlayer();
+    GifAnimation *decode(fs::FS &fs, const char *path); // LittleFS, SD, ...; nullptr if unusable
+    void setAnimation(GifAnimation *next); // Takes it over, stops playback and frees the previous one
+    bool loadGIF(fs::FS &fs, const char *path); // decode() and setAnimation() in one go
+    uint16_t getFrameCount();
+    void setScaleMode(ScaleMode mode) { scaleMode = mode; } // For the next decode()
+
+    // Plays until durationMs passed or the animation ran loops times, whichever
+    // comes first (0 = no limit, not both). The first frame shows on the next tick().
+    bool start(unsigned long durationMs, uint16_t loops = 0);
+    void stop(); // Leaves the last frame on the display
+    bool isPlaying() { return playing; }
+    unsigned long tick(); // Milliseconds until the next frame is due, 0 once finished
 
 private:
     ClockDisplayHAL *clockDisplayHAL;
     AnimatedGIF gif;
+    GifAnimation *animation; // Being played
+
+    bool playing;
+    unsigned long startMs;
+    unsigned long durationMs;
+    uint16_t loopLimit;
+    uint16_t loopsDone;
+    uint16_t frameIndex;
+    int32_t shownIndex;        // Frame on the display, -1 before the first tick
+    unsigned long frameDueMs;  // When frameIndex started, on the animation's own timeline
+
+    fs::FS *openFs; // File system of the decode() in progress
+
+    // Composed image at the GIF's own size while decoding; frames only paint
+    // the rectangle they change
+    uint8_t *canvas;
+    uint16_t canvasWidth;
+    uint16_t canvasHeight;
+    bool frameDrawn;
+
+    // Part of the canvas that is scaled, and where it lands on the display
+    ScaleMode scaleMode;
+    uint16_t srcX, srcY, srcWidth, srcHeight;
+    uint8_t dstX, dstY, dstWidth, dstHeight;
+
     static void GIFDraw(GIFDRAW *pDraw);
+    static void *GIFOpen(const char *path, int32_t *size);
+    static void GIFClose(void *handle);
+    static int32_t GIFRead(GIFFILE *file, uint8_t *buffer, int32_t length);
+    static int32_t GIFSeek(GIFFILE *file, int32_t position);
+    void showFrame(const Frame &frame);
+    void planScaling();
+    void scaleCanvas(Frame &frame);
 
     static GifPlayer *instance;
 };
 
+struct GifAnimation
+{
+    GifPlayer::Frame *frames;
+    uint16_t frameCount;
+
+    GifAnimation() : frames(nullptr), frameCount(0) {}
+    ~GifAnimation() { free(frames); }
+};
+
 #endif
@@ -0,0 +1,18 @@
+#ifndef LED_OUTPUT_H
+#define LED_OUTPUT_H
+
+#include <Arduino.h>
+
+// Pushes finished frames to the physical LED strip.
+// Pixels are 0xRRGGBB in strip order; implementations handle wire order and timing.
+class LedOutput
+{
+public:
+    virtual ~LedOutput() {}
+    virtual void begin() = 0;
+    virtual void write(const uint32_t *pixels, uint16_t numPixels) = 0;
+    virtual const char *getName() = 0;
+    virtual uint32_t getInterruptsOffUs() { return 0; } // Upper bound for the last write(), 0 if never masked
+};
+
+#endif
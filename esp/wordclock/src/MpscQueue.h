@@ -0,0 +1,78 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Bounded lock-free ring buffer for any number of producer tasks and exactly
+// one consumer. Each slot carries a sequence number, so producers claim slots
+// with a single compare-and-swap and never wait on each other or the consumer.
+// A full queue rejects the item.
+template <typename T, uint8_t CAPACITY>
+class MpscQueue
+{
+public:
+    MpscQueue() : enqueuePos(0), dequeuePos(0)
+    {
+        for (uint32_t i = 0; i < CAPACITY; i++)
+        {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Any task
+    bool push(const T &item)
+    {
+        uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot &slot = slots[pos & MASK];
+            int32_t diff = (int32_t)(slot.sequence.load(std::memory_order_acquire) - pos);
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    slot.item = item;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // Full
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer task only
+    bool pop(T &item)
+    {
+        Slot &slot = slots[dequeuePos & MASK];
+        if ((int32_t)(slot.sequence.load(std::memory_order_acquire) - (dequeuePos + 1)) < 0)
+            return false; // Empty, or a producer has not finished writing this slot yet
+        item = slot.item;
+        slot.sequence.store(dequeuePos + CAPACITY, std::memory_order_release);
+        dequeuePos++;
+        return true;
+    }
+
+private:
+    static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "MpscQueue capacity must be a power of two");
+    static const uint32_t MASK = CAPACITY - 1;
+
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence;
+        T item;
+    };
+
+    Slot slots[CAPACITY];
+    std::atomic<uint32_t> enqueuePos;
+    uint32_t dequeuePos;
+};
+
+#endif
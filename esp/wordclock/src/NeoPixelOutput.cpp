@@ -0,0 +1,28 @@
+#include "NeoPixelOutput.h"
+
+NeoPixelOutput::NeoPixelOutput(uint8_t pin, uint16_t numPixels)
+    : strip(numPixels, pin, NEO_GRB + NEO_KHZ800), showUs(0)
+{
+}
+
+void NeoPixelOutput::begin()
+{
+    strip.setBrightness(255);
+    strip.begin();
+}
+
+void NeoPixelOutput::write(const uint32_t *pixels, uint16_t numPixels)
+{
+    for (uint16_t i = 0; i < numPixels; i++)
+    {
+        strip.setPixelColor(i, pixels[i]);
+    }
+    uint32_t start = micros();
+    strip.show();
+    showUs = micros() - start;
+}
+
+const char *NeoPixelOutput::getName()
+{
+    return "NeoPixel";
+}
@@ -0,0 +1,22 @@
+#ifndef NEOPIXEL_OUTPUT_H
+#define NEOPIXEL_OUTPUT_H
+
+#include <Adafruit_NeoPixel.h>
+#include "LedOutput.h"
+
+// Blocking output through Adafruit_NeoPixel (interrupts are masked while the frame is sent)
+class NeoPixelOutput : public LedOutput
+{
+public:
+    NeoPixelOutput(uint8_t pin, uint16_t numPixels);
+    void begin() override;
+    void write(const uint32_t *pixels, uint16_t numPixels) override;
+    const char *getName() override;
+    uint32_t getInterruptsOffUs() override { return showUs; }
+
+private:
+    Adafruit_NeoPixel strip;
+    uint32_t showUs; // Last show() as a whole; interrupts are masked for at most that long
+};
+
+#endif
@@ -1,23 +1,45 @@
 #include "NetworkManager.h"
 #include "SerialHelper.h"
+#include "BootTrace.h"
 #include "esp_task_wdt.h"
 
-#define MAX_GIF_SIZE 32768 // 32KB limit
 #define AP_SSID "WordClock"
 
+#ifndef WIFI_REUSE_DHCP_LEASE
+#define WIFI_REUSE_DHCP_LEASE 0 // 1 = reconnect with the last DHCP address as a static IP
+#endif
+
+#if WIFI_REUSE_DHCP_LEASE
+#include "esp_netif.h"
+#include "esp_netif_net_stack.h"
+#include "lwip/dhcp.h"
+
+static const time_t MIN_VALID_EPOCH = 1483228800; // 2017-01-01, same cut-off as WordClock
+
+// Lease time the router granted the station interface, 0 if unknown
+static uint32_t dhcpLeaseSeconds()
+{
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    struct netif *lwipNetif = netif ? (struct netif *)esp_netif_get_netif_impl(netif) : nullptr;
+    struct dhcp *dhcp = lwipNetif ? netif_dhcp_data(lwipNetif) : nullptr;
+    return dhcp ? dhcp->offered_t0_lease : 0;
+}
+#endif
+
 // Static instance pointer for callbacks
 NetworkManager* NetworkManager::instance = nullptr;
 
+// Asked all at once; the fastest healthy one sets the clock
+const char *NetworkManager::DEFAULT_NTP_SERVERS = "pool.ntp.org,time.google.com,time.cloudflare.com";
+
 NetworkManager::NetworkManager(long defaultGmtOffset_sec, int defaultDaylightOffset_sec)
-    : defaultGmtOffset_sec(defaultGmtOffset_sec),
+    : gmtOffset_sec(defaultGmtOffset_sec),
+      daylightOffset_sec(defaultDaylightOffset_sec),
+      defaultGmtOffset_sec(defaultGmtOffset_sec),
       defaultDaylightOffset_sec(defaultDaylightOffset_sec),
-      gmtOffset_sec(defaultGmtOffset_sec), 
-      daylightOffset_sec(defaultDaylightOffset_sec), 
-      lastSyncTime(0), 
-      lastConnectionAttempt(0),
       apModeStartTime(0),
-      gifBuffer(nullptr), 
-      gifBufferSize(0),
+      usingConnectionCache(false),
+      usingCachedLease(false),
       webConfigServer(nullptr),
       apModeActive(false),
       scanInProgress(false),
@@ -25,13 +47,21 @@ NetworkManager::NetworkManager(long defaultGmtOffset_sec, int defaultDaylightOff
       lastScanTime(0),
       scanStartTime(0),
       scanRetryCount(0),
+      setupScanStarted(false),
+      setupServerPending(false),
       resetButtonPin(-1),
       buttonPressStart(0),
       buttonPressed(false),
-      triggerGifCallback(nullptr),
-      triggerWordsTestCallback(nullptr),
-      triggerLedTestCallback(nullptr),
-      resumeNormalCallback(nullptr)
+      resetRequested(false),
+      syncedTime(&timeSync),
+      ntpStatus(),
+      ntpStatusLock(portMUX_INITIALIZER_UNLOCKED),
+      timeSyncedEvent(false),
+      flipToMeasure(false),
+      flipErrorUs(0),
+      flipProbeRunning(false),
+      displayCommands(nullptr),
+      timeCache(nullptr)
 {
     instance = this; // Set static instance for callbacks
 }
@@ -39,33 +69,22 @@ NetworkManager::NetworkManager(long defaultGmtOffset_sec, int defaultDaylightOff
 void NetworkManager::setup()
 {
     WiFi.mode(WIFI_STA);
-    WiFi.setAutoReconnect(false);
+    WiFi.setAutoReconnect(false); // WiFiStateMachine decides when to retry
+    WiFi.onEvent(onWiFiEvent);
     
-    // Load timezone settings from flash (or use defaults)
-    loadTimezoneSettings();
-    
-    // Try to load stored credentials
-    if (loadCredentials() && storedSSID.length() > 0)
+    // Load timezone settings from flash (or use defaults) unless main already did
+    if (tzString.length() == 0)
     {
-        SERIAL_PRINTLN("Attempting to connect to stored WiFi...");
-        esp_task_wdt_reset(); // Feed watchdog before connection attempt
-        
-        if (connectToWiFi())
-        {
-            SERIAL_PRINTLN("WiFi connected successfully");
-            syncTimeWithNTP();
-            apModeActive = false;
-            
-            // Start web server in normal mode
-            startNormalModeWebServer();
-            return;
-        }
+        loadTimezoneSettings();
     }
     
-    // If connection failed, start AP mode
-    SERIAL_PRINTLN("Could not connect to WiFi. Starting AP mode...");
-    esp_task_wdt_reset(); // Feed watchdog before starting AP mode
-    startAPMode();
+    // Returns right away; update() follows the connection from here
+    bool haveCredentials = loadCredentials() && storedSSID.length() > 0;
+    if (!haveCredentials)
+    {
+        SERIAL_PRINTLN("No stored WiFi. Starting AP mode...");
+    }
+    applyConnectionAction(connection.start(haveCredentials, millis()));
 }
 
 void NetworkManager::update()
@@ -73,6 +92,16 @@ void NetworkManager::update()
     // Feed watchdog at start of update
     esp_task_wdt_reset();
     
+    // Settings belong to this task, so a reset from the button happens here
+    if (resetRequested)
+    {
+        SERIAL_PRINTLN("RESET! Clearing all settings...");
+        clearAllSettings();
+        SERIAL_PRINTLN("Rebooting...");
+        delay(1000);
+        ESP.restart();
+    }
+    
     // Check if async WiFi scan is complete
     if (scanInProgress)
     {
@@ -143,6 +172,11 @@ void NetworkManager::update()
         }
     }
     
+    if (apModeActive)
+    {
+        updateAPSetup();
+    }
+    
     // Retry scan if needed
     if (apModeActive && scanRetryCount > 0 && scanRetryCount <= 3 && !scanInProgress)
     {
@@ -162,81 +196,143 @@ void NetworkManager::update()
         yield(); // Allow other tasks to run
     }
     
-    // AP mode specific logic
-    if (apModeActive)
+    if (isConnected())
     {
-        // Check if we should try to reconnect or timeout
-        unsigned long currentMillis = millis();
+        processTimeSync();
+    }
+    
+    // Link events arrive on the WiFi event task
+    WiFiLinkEvent event;
+    while (linkEvents.pop(event))
+    {
+        applyConnectionAction(connection.handleEvent(event, millis()));
+    }
+    
+    // A station attempt would abort a running scan, so it waits for the scan
+    if (!scanInProgress)
+    {
+        applyConnectionAction(connection.update(millis()));
+    }
+    
+    // Check for timeout (10 minutes in AP mode)
+    if (apModeActive && millis() - apModeStartTime >= apModeTimeout)
+    {
+        SERIAL_PRINTLN("AP mode timeout reached. Rebooting...");
+        delay(1000);
+        ESP.restart();
+    }
+}
+
+void NetworkManager::onWiFiEvent(arduino_event_id_t event)
+{
+    // Runs on the WiFi event task: only hand the event over
+    if (!instance)
+    {
+        return;
+    }
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP)
+    {
+        instance->linkEvents.push(WIFI_LINK_GOT_IP);
+    }
+    else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED || event == ARDUINO_EVENT_WIFI_STA_LOST_IP)
+    {
+        instance->linkEvents.push(WIFI_LINK_DISCONNECTED);
+    }
+}
+
+void NetworkManager::applyConnectionAction(WiFiAction action)
+{
+    switch (action)
+    {
+    case WIFI_ACTION_BEGIN:
+        beginConnection();
+        break;
+        
+    case WIFI_ACTION_CONNECTED:
+        onConnected();
+        break;
+        
+    case WIFI_ACTION_LOST:
+        SERIAL_PRINT("WiFi connection lost, retrying in ");
+        SERIAL_PRINT(String(connection.getRetryDelay()).c_str());
+        SERIAL_PRINTLN(" ms");
+        break;
         
-        // Check for timeout (10 minutes in AP mode)
-        if (currentMillis - apModeStartTime >= apModeTimeout)
+    case WIFI_ACTION_FAILED:
+    case WIFI_ACTION_START_AP:
+        if (usingConnectionCache)
         {
-            SERIAL_PRINTLN("AP mode timeout reached. Rebooting...");
-            delay(1000);
-            ESP.restart();
+            // Access point moved or changed channel: forget it and scan next time
+            clearConnectionCache();
+            usingConnectionCache = false;
         }
-        
-        // Periodically retry connection if credentials exist
-        if (storedSSID.length() > 0 && currentMillis - lastConnectionAttempt >= retryInterval)
+        SERIAL_PRINT("Connection failed (");
+        SERIAL_PRINT(String(connection.getFailures()).c_str());
+        SERIAL_PRINT(" in a row), retrying in ");
+        SERIAL_PRINT(String(connection.getRetryDelay()).c_str());
+        SERIAL_PRINTLN(" ms");
+        if (action == WIFI_ACTION_START_AP && !apModeActive)
         {
-            SERIAL_PRINTLN("Retrying WiFi connection...");
-            lastConnectionAttempt = currentMillis;
-            
-            esp_task_wdt_reset(); // Feed watchdog before connection attempt
-            
-            if (connectToWiFi())
-            {
-                SERIAL_PRINTLN("WiFi connected! Stopping AP mode...");
-                
-                // Stop web config server
-                if (webConfigServer)
-                {
-                    webConfigServer->stop();
-                    delete webConfigServer;
-                    webConfigServer = nullptr;
-                }
-                
-                // Clear scan state
-                if (scanInProgress || WiFi.scanComplete() != WIFI_SCAN_FAILED)
-                {
-                    WiFi.scanDelete();
-                }
-                scanInProgress = false;
-                cachedNetworksJSON = "";
-                
-                WiFi.softAPdisconnect(true);
-                WiFi.mode(WIFI_STA); // Switch to STA only mode
-                apModeActive = false;
-                syncTimeWithNTP();
-                
-                // Start web server in normal mode
-                startNormalModeWebServer();
-                return;
-            }
+            SERIAL_PRINTLN("Could not connect to WiFi. Starting AP mode...");
+            esp_task_wdt_reset(); // Feed watchdog before starting AP mode
+            startAPMode();
         }
+        break;
+        
+    case WIFI_ACTION_NONE:
+        break;
     }
-    else
+}
+
+void NetworkManager::onConnected()
+{
+    SERIAL_PRINT("Connected! IP: ");
+    SERIAL_PRINTLN(WiFi.localIP().toString().c_str());
+    BootTrace::mark("wifi connected");
+    
+    // A scanned access point or a DHCP address is worth remembering
+    if (!usingConnectionCache || (WIFI_REUSE_DHCP_LEASE && !usingCachedLease))
     {
-        // Normal mode - sync time periodically
-        unsigned long currentMillis = millis();
-        if (currentMillis - lastSyncTime >= syncInterval)
+        saveConnectionCache();
+    }
+    
+    if (apModeActive)
+    {
+        SERIAL_PRINTLN("WiFi connected! Stopping AP mode...");
+        
+        // Stop web config server
+        if (webConfigServer)
         {
-            syncTimeWithNTP();
+            webConfigServer->stop();
+            delete webConfigServer;
+            webConfigServer = nullptr;
         }
         
-        // Check if WiFi is still connected
-        if (WiFi.status() != WL_CONNECTED)
+        // Clear scan state
+        if (scanInProgress || WiFi.scanComplete() != WIFI_SCAN_FAILED)
         {
-            SERIAL_PRINTLN("WiFi disconnected. Attempting reconnect...");
-            esp_task_wdt_reset(); // Feed watchdog before reconnection
-            
-            if (!connectToWiFi())
-            {
-                SERIAL_PRINTLN("Reconnection failed. Starting AP mode...");
-                startAPMode();
-            }
+            WiFi.scanDelete();
         }
+        scanInProgress = false;
+        setupServerPending = false;
+        cachedNetworksJSON = "";
+        
+        WiFi.softAPdisconnect(true);
+        WiFi.mode(WIFI_STA); // Switch to STA only mode
+        apModeActive = false;
     }
+    
+    startTimeSync();
+    
+    // Start web server in normal mode (no-op after a reconnect)
+    startNormalModeWebServer();
+}
+
+void NetworkManager::updateTimeSync()
+{
+    // NtpClient polls at the interval TimeSync::adaptInterval() picks; in
+    // between, slew out the measured drift
+    timeSync.correctDrift();
 }
 
 bool NetworkManager::loadCredentials()
@@ -254,13 +350,15 @@ bool NetworkManager::loadCredentials()
 
 void NetworkManager::saveCredentials(String ssid, String password)
 {
-    preferences.begin("wifi", false); // Read-write
-    preferences.putString("ssid", ssid);
-    preferences.putString("password", password);
-    preferences.end();
-    
-    storedSSID = ssid;
-    storedPassword = password;
+    // Runs on the web server task, so only flash is written through a handle
+    // of its own; the reboot that follows the save loads the new credentials
+    Preferences wifiPreferences;
+    wifiPreferences.begin("wifi", false); // Read-write
+    wifiPreferences.putString("ssid", ssid);
+    wifiPreferences.putString("password", password);
+    wifiPreferences.remove("bssid"); // Cached access point belongs to the old network
+    wifiPreferences.remove("channel");
+    wifiPreferences.end();
     
     SERIAL_PRINTLN("Credentials saved to flash");
 }
@@ -324,29 +422,64 @@ void NetworkManager::saveTimezoneSettings(String newTzString)
     SERIAL_PRINT(String(newTzString.length()).c_str());
     SERIAL_PRINTLN(")");
     
-    preferences.begin("timezone", false); // Read-write
+    // Web server task: flash only, like saveCredentials()
+    Preferences timezonePreferences;
+    timezonePreferences.begin("timezone", false); // Read-write
     
     // Remove old format keys if they exist
-    if (preferences.isKey("gmtOffset"))
+    if (timezonePreferences.isKey("gmtOffset"))
     {
         SERIAL_PRINTLN("Removing old gmtOffset key");
-        preferences.remove("gmtOffset");
+        timezonePreferences.remove("gmtOffset");
     }
-    if (preferences.isKey("dstOffset"))
+    if (timezonePreferences.isKey("dstOffset"))
     {
         SERIAL_PRINTLN("Removing old dstOffset key");
-        preferences.remove("dstOffset");
+        timezonePreferences.remove("dstOffset");
     }
     
     // Save new TZ string
-    preferences.putString("tzString", newTzString);
-    preferences.end();
-    
-    tzString = newTzString;
+    timezonePreferences.putString("tzString", newTzString);
+    timezonePreferences.end();
     
     SERIAL_PRINTLN("Timezone settings saved to flash successfully");
-    SERIAL_PRINT("Stored TZ String: ");
-    SERIAL_PRINTLN(tzString.c_str());
+}
+
+void NetworkManager::loadNtpServers()
+{
+    ntpServers = readNtpServers();
+}
+
+String NetworkManager::readNtpServers()
+{
+    // Own handle: the shared one belongs to the network task
+    Preferences ntpPreferences;
+    ntpPreferences.begin("ntp", true); // Read-only
+    String servers = ntpPreferences.getString("servers", "");
+    ntpPreferences.end();
+    
+    return servers.length() ? servers : String(DEFAULT_NTP_SERVERS);
+}
+
+void NetworkManager::saveNtpServers(String servers)
+{
+    // Runs on the web server task, so only flash is written; the reboot that
+    // follows the save hands the list to the network task
+    servers.trim();
+    Preferences ntpPreferences;
+    ntpPreferences.begin("ntp", false); // Read-write
+    if (servers.length() == 0)
+    {
+        ntpPreferences.remove("servers"); // Back to the defaults
+    }
+    else
+    {
+        ntpPreferences.putString("servers", servers);
+    }
+    ntpPreferences.end();
+    
+    SERIAL_PRINT("NTP servers saved: ");
+    SERIAL_PRINTLN(servers.length() ? servers.c_str() : DEFAULT_NTP_SERVERS);
 }
 
 void NetworkManager::clearAllSettings()
@@ -361,6 +494,12 @@ void NetworkManager::clearAllSettings()
     preferences.clear();
     preferences.end();
     
+    preferences.begin("ntp", false);
+    preferences.clear();
+    preferences.end();
+    
+    animationStore.clear();
+    
     storedSSID = "";
     storedPassword = "";
     gmtOffset_sec = defaultGmtOffset_sec;
@@ -401,10 +540,7 @@ bool NetworkManager::checkResetButton()
             // Check if held for 3+ seconds
             if (pressDuration >= 3000)
             {
-                SERIAL_PRINTLN("RESET! Clearing all settings...");
-                
-                // Clear all settings
-                clearAllSettings();
+                SERIAL_PRINTLN("Reset button held for 3 seconds");
                 
                 // Return true to signal that reset was triggered
                 return true;
@@ -428,13 +564,13 @@ bool NetworkManager::checkResetButton()
     return false;
 }
 
-bool NetworkManager::connectToWiFi()
+void NetworkManager::requestReset()
+{
+    resetRequested = true;
+}
+
+void NetworkManager::beginConnection()
 {
-    if (storedSSID.length() == 0)
-    {
-        return false;
-    }
-    
     SERIAL_PRINT("Connecting to: ");
     SERIAL_PRINTLN(storedSSID.c_str());
     
@@ -445,110 +581,172 @@ bool NetworkManager::connectToWiFi()
         WiFi.mode(WIFI_STA);
     }
     
-    WiFi.begin(storedSSID.c_str(), storedPassword.c_str());
+    // The first attempt joins the last access point on its channel, which
+    // skips the full channel scan; after a failure it scans again
+    uint8_t bssid[6];
+    uint8_t channel;
+    usingCachedLease = false;
+    usingConnectionCache = connection.getFailures() == 0 && loadConnectionCache(bssid, &channel);
+    if (usingConnectionCache)
+    {
+        SERIAL_PRINT("Using cached access point on channel ");
+        SERIAL_PRINTLN(String(channel).c_str());
+        WiFi.begin(storedSSID.c_str(), storedPassword.c_str(), channel, bssid);
+    }
+    else
+    {
+        WiFi.begin(storedSSID.c_str(), storedPassword.c_str());
+    }
+}
+
+bool NetworkManager::loadConnectionCache(uint8_t *bssid, uint8_t *channel)
+{
+    preferences.begin("wifi", true); // Read-only
+    bool found = preferences.getBytes("bssid", bssid, 6) == 6;
+    *channel = preferences.getUChar("channel", 0);
+#if WIFI_REUSE_DHCP_LEASE
+    IPAddress ip(preferences.getULong("ip", 0));
+    IPAddress gateway(preferences.getULong("gateway", 0));
+    IPAddress subnet(preferences.getULong("subnet", 0));
+    IPAddress dns(preferences.getULong("dns", 0));
+    uint32_t leaseStart = preferences.getULong("leaseStart", 0);
+    uint32_t leaseTime = preferences.getULong("leaseTime", 0);
+#endif
+    preferences.end();
     
-    unsigned long startAttempt = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - startAttempt < connectionTimeout)
+    if (!found || *channel == 0)
     {
-        delay(100); // Shorter delay for more responsive button checking
-        esp_task_wdt_reset(); // Feed watchdog during connection attempt
-        yield(); // Allow other tasks to run
-        
-        // Check reset button during connection attempt
-        if (checkResetButton())
-        {
-            SERIAL_PRINTLN("\nReset triggered during connection. Rebooting...");
-            delay(1000);
-            ESP.restart();
-        }
-        
-        // Print progress every 500ms
-        static unsigned long lastPrint = 0;
-        if (millis() - lastPrint >= 500)
-        {
-            SERIAL_PRINT(".");
-            lastPrint = millis();
-        }
+        return false;
     }
-    SERIAL_PRINTLN("");
     
-    if (WiFi.status() == WL_CONNECTED)
+#if WIFI_REUSE_DHCP_LEASE
+    // Skips DHCP. Risky if the router hands the address to someone else, so
+    // only while the lease has not run out (which needs a valid clock), and a
+    // failed attempt drops back to DHCP through clearConnectionCache()
+    time_t now = time(nullptr);
+    usingCachedLease = (uint32_t)ip != 0 && leaseStart > 0 && leaseTime > 0 &&
+                       now >= (time_t)leaseStart && now - (time_t)leaseStart < (time_t)leaseTime;
+    if (usingCachedLease)
+    {
+        WiFi.config(ip, gateway, subnet, dns);
+    }
+    else
+    {
+        WiFi.config(IPAddress(), IPAddress(), IPAddress()); // DHCP, saved again once connected
+    }
+#endif
+    return true;
+}
+
+void NetworkManager::saveConnectionCache()
+{
+    uint8_t *bssid = WiFi.BSSID();
+    uint8_t channel = (uint8_t)WiFi.channel();
+    if (!bssid || channel == 0)
     {
-        SERIAL_PRINT("Connected! IP: ");
-        SERIAL_PRINTLN(WiFi.localIP().toString().c_str());
-        return true;
+        return;
     }
     
-    SERIAL_PRINTLN("Connection failed");
-    return false;
+    uint8_t cachedBssid[6];
+    preferences.begin("wifi", false); // Read-write
+    bool changed = preferences.getBytes("bssid", cachedBssid, 6) != 6 ||
+                   memcmp(cachedBssid, bssid, 6) != 0 ||
+                   preferences.getUChar("channel", 0) != channel;
+    if (changed)
+    {
+        // Only write when the access point changed, to spare the flash
+        preferences.putBytes("bssid", bssid, 6);
+        preferences.putUChar("channel", channel);
+        SERIAL_PRINTLN("Access point cached for the next connect");
+    }
+#if WIFI_REUSE_DHCP_LEASE
+    // Only called after DHCP ran: the router may have moved the address, and
+    // the lease runs from now
+    if (!usingCachedLease)
+    {
+        uint32_t ip = (uint32_t)WiFi.localIP();
+        uint32_t gateway = (uint32_t)WiFi.gatewayIP();
+        uint32_t subnet = (uint32_t)WiFi.subnetMask();
+        uint32_t dns = (uint32_t)WiFi.dnsIP();
+        if (preferences.getULong("ip", 0) != ip || preferences.getULong("gateway", 0) != gateway ||
+            preferences.getULong("subnet", 0) != subnet || preferences.getULong("dns", 0) != dns)
+        {
+            preferences.putULong("ip", ip);
+            preferences.putULong("gateway", gateway);
+            preferences.putULong("subnet", subnet);
+            preferences.putULong("dns", dns);
+            SERIAL_PRINTLN("DHCP address cached for the next connect");
+        }
+        time_t now = time(nullptr);
+        preferences.putULong("leaseStart", now >= MIN_VALID_EPOCH ? (uint32_t)now : 0); // No clock yet: not reused
+        preferences.putULong("leaseTime", dhcpLeaseSeconds());
+    }
+#endif
+    preferences.end();
+}
+
+void NetworkManager::clearConnectionCache()
+{
+    preferences.begin("wifi", false); // Read-write
+    preferences.remove("bssid");
+    preferences.remove("channel");
+#if WIFI_REUSE_DHCP_LEASE
+    preferences.remove("ip");
+    preferences.remove("gateway");
+    preferences.remove("subnet");
+    preferences.remove("dns");
+    preferences.remove("leaseStart");
+    preferences.remove("leaseTime");
+    WiFi.config(IPAddress(), IPAddress(), IPAddress()); // Back to DHCP
+#endif
+    preferences.end();
 }
 
 void NetworkManager::startAPMode()
 {
     apModeActive = true;
     apModeStartTime = millis();
-    lastConnectionAttempt = millis();
     
     // Disconnect from any WiFi connections first
     WiFi.disconnect(true);
-    delay(100);
     
     // Use AP_STA mode to allow scanning while in AP mode
     WiFi.mode(WIFI_AP_STA);
-    delay(100); // Let WiFi mode stabilize
-    
-    // Start the AP
     WiFi.softAP(AP_SSID);
-    delay(100); // Let AP stabilize
     
     SERIAL_PRINT("AP Mode started. SSID: ");
     SERIAL_PRINTLN(AP_SSID);
     SERIAL_PRINT("AP IP address: ");
     SERIAL_PRINTLN(WiFi.softAPIP().toString().c_str());
     
-    // Do initial WiFi scan BEFORE starting web server to avoid TCP conflicts
-    SERIAL_PRINTLN("Performing initial WiFi scan before starting web server...");
-    startNetworkScan();
-    
-    // Wait for scan to complete (with timeout)
-    unsigned long scanStart = millis();
-    while (scanInProgress && (millis() - scanStart < 15000))
+    // update() scans, then starts the web server; nothing here waits
+    setupScanStarted = false;
+    setupServerPending = true;
+}
+
+void NetworkManager::updateAPSetup()
+{
+    // startNetworkScan() holds off while the AP is settling
+    if (!setupServerPending || scanInProgress || millis() - apModeStartTime < 2000)
     {
-        delay(100);
-        esp_task_wdt_reset();
-        // Check if async scan completed
-        int result = WiFi.scanComplete();
-        if (result >= 0 || result == WIFI_SCAN_FAILED)
-        {
-            if (result >= 0)
-            {
-                SERIAL_PRINT("Initial scan found ");
-                SERIAL_PRINT(String(result).c_str());
-                SERIAL_PRINTLN(" networks");
-                cachedNetworksJSON = buildNetworksJSON(result);
-                lastScanTime = millis();
-            }
-            scanInProgress = false;
-            break;
-        }
+        return;
     }
-    
-    if (scanInProgress)
+    if (!setupScanStarted)
     {
-        SERIAL_PRINTLN("Initial scan timed out, will retry later");
-        WiFi.scanDelete();
-        scanInProgress = false;
+        // Initial WiFi scan BEFORE the web server, to avoid TCP conflicts
+        SERIAL_PRINTLN("Performing initial WiFi scan before starting web server...");
+        setupScanStarted = true;
+        startNetworkScan();
+        return;
     }
     
-    // Now it's safe to start the web server with cached results
+    // Scan done, failed or timed out: start with whatever results are cached
+    setupServerPending = false;
     webConfigServer = new WebConfigServer();
     webConfigServer->onSaveConfig(onWebSaveConfig);
     webConfigServer->onGetNetworks(onWebGetNetworks);
     webConfigServer->onStartScan(onWebStartScan);
     webConfigServer->start(WiFi.softAPIP(), MODE_SETUP);
-    
-    // WebConfigServer will trigger the initial scan automatically
-    // No blocking delays here to prevent watchdog timeouts
 }
 
 void NetworkManager::startNetworkScan()
@@ -578,13 +776,11 @@ void NetworkManager::startNetworkScan()
     
     // Ensure we're in the right mode
     WiFi.mode(WIFI_AP_STA);
-    delay(100); // Give mode change time to settle
     
-    // Make sure station is disconnected
+    // Make sure station is disconnected; a scan that still collides is retried
     if (WiFi.status() == WL_CONNECTED)
     {
         WiFi.disconnect(false);
-        delay(200); // Increased delay for disconnect to complete
     }
     
     scanInProgress = true;
@@ -682,7 +878,7 @@ String NetworkManager::getNetworksJSON()
 
 bool NetworkManager::isConnected()
 {
-    return !apModeActive && WiFi.status() == WL_CONNECTED;
+    return !apModeActive && connection.getState() == WIFI_STATE_CONNECTED;
 }
 
 bool NetworkManager::isInAPMode()
@@ -690,173 +886,145 @@ bool NetworkManager::isInAPMode()
     return apModeActive;
 }
 
-void NetworkManager::syncTimeWithNTP()
+void NetworkManager::startTimeSync()
 {
-    const char *ntpServer = "pool.ntp.org";
+    loadNtpServers();
     
     SERIAL_PRINTLN("=== Starting NTP Time Sync ===");
     SERIAL_PRINT("Timezone string: ");
     SERIAL_PRINTLN(tzString.c_str());
+    SERIAL_PRINT("NTP servers: ");
+    SERIAL_PRINTLN(ntpServers.c_str());
     
-    // Configure NTP client FIRST (with 0 offsets)
-    SERIAL_PRINTLN("Configuring NTP client...");
-    configTime(0, 0, ntpServer);
+    // The result arrives later through processTimeSync()
+    timeSync.begin(tzString.c_str(), ntpServers, timeCache ? timeCache->getDriftPpb() : 0);
+    publishNtpStatus();
+}
 
-    // Wait for time to be set (up to 10 seconds)
-    SERIAL_PRINTLN("Waiting for NTP time sync...");
-    int retry = 0;
-    const int maxRetries = 20;
-    struct tm timeinfo;
-    
-    while (retry < maxRetries)
+void NetworkManager::processTimeSync()
+{
+    bool wasPolling = timeSync.isPolling();
+    bool synced = timeSync.update();
+    if (wasPolling && !timeSync.isPolling())
     {
-        if (getLocalTime(&timeinfo))
-        {
-            // Time successfully retrieved from NTP
-            SERIAL_PRINTLN("NTP sync successful!");
-            break;
-        }
-        delay(500);
-        retry++;
-        esp_task_wdt_reset(); // Feed watchdog during wait
+        publishNtpStatus();
     }
-    
-    if (retry >= maxRetries)
+    reportFlipError();
+    if (!synced)
     {
-        SERIAL_PRINTLN("ERROR: Failed to obtain time from NTP after retries");
-        lastSyncTime = millis();
         return;
     }
     
-    // NOW set timezone using POSIX TZ string (enables automatic DST switching)
-    SERIAL_PRINTLN("Applying timezone...");
-    SERIAL_PRINT("Setting TZ environment variable to: ");
-    SERIAL_PRINTLN(tzString.c_str());
-    
-    setenv("TZ", tzString.c_str(), 1);
-    tzset();
-    
-    // Small delay to ensure timezone is applied
-    delay(100);
-    
-    // Verify timezone was applied correctly
-    if (getLocalTime(&timeinfo))
+    struct tm timeinfo;
+    if (getLocalTime(&timeinfo, 0))
     {
         char timeStr[64];
         strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S %Z (UTC%z)", &timeinfo);
-        SERIAL_PRINTLN("=== Timezone Applied Successfully ===");
         SERIAL_PRINT("Local time: ");
         SERIAL_PRINTLN(timeStr);
-        SERIAL_PRINT("Hour: ");
-        SERIAL_PRINT(String(timeinfo.tm_hour).c_str());
-        SERIAL_PRINT(", Minute: ");
-        SERIAL_PRINTLN(String(timeinfo.tm_min).c_str());
-        SERIAL_PRINT("Is DST active: ");
-        SERIAL_PRINTLN(timeinfo.tm_isdst > 0 ? "Yes" : "No");
     }
-    else
+    
+    BootTrace::mark("ntp synced");
+    timeSyncedEvent = true;
+    if (timeCache)
     {
-        SERIAL_PRINTLN("ERROR: Could not get local time after timezone set");
+        timeCache->recordSync(timeSync.getDriftPpb());
     }
-    
-    lastSyncTime = millis();
 }
 
-struct tm NetworkManager::getLocalTimeStruct()
+void NetworkManager::publishNtpStatus()
 {
-    struct tm timeinfo;
-    if (getLocalTime(&timeinfo))
+    NtpStatus status = {};
+    status.synced = timeSync.isSynced();
+    status.offsetMs = timeSync.getLastOffsetMs();
+    status.driftPpb = timeSync.getDriftPpb();
+    status.intervalMs = timeSync.getIntervalMs();
+    status.source = timeSync.getSourceIndex();
+    NtpClient &client = timeSync.getClient();
+    status.serverCount = client.getServerCount();
+    for (uint8_t i = 0; i < status.serverCount; i++)
     {
-        return timeinfo;
-    }
-    else
-    {
-        memset(&timeinfo, 0, sizeof(struct tm));
-        SERIAL_PRINTLN("Failed to obtain local time");
-        return timeinfo;
+        const NtpServer &server = client.getServer(i);
+        strncpy(status.servers[i].host, server.host.c_str(), sizeof(status.servers[i].host) - 1);
+        status.servers[i].healthy = server.healthy;
+        status.servers[i].rttUs = server.rttUs;
+        status.servers[i].offsetUs = server.offsetUs;
+        status.servers[i].stratum = server.stratum;
     }
+    
+    portENTER_CRITICAL(&ntpStatusLock);
+    ntpStatus = status;
+    portEXIT_CRITICAL(&ntpStatusLock);
 }
 
-bool NetworkManager::downloadGIF(const char *gifUrl)
+bool NetworkManager::takeTimeSynced()
 {
-    if (WiFi.status() == WL_CONNECTED)
-    {
-        HTTPClient http;
-        http.begin(gifUrl);
+    bool synced = timeSyncedEvent;
+    timeSyncedEvent = false;
+    return synced;
+}
 
-        int httpResponseCode = http.GET();
-        if (httpResponseCode == HTTP_CODE_OK)
-        {
-            int gifSize = http.getSize();
+bool NetworkManager::isTimeSyncPolling()
+{
+    return timeSync.isPolling();
+}
 
-            if (gifSize > MAX_GIF_SIZE)
-            {
-                SERIAL_PRINTLN("GIF is too large. Max size allowed is 32KB.");
-                http.end();
-                return false;
-            }
+void NetworkManager::measureFlip(int32_t localErrorUs)
+{
+    flipErrorUs = localErrorUs;
+    flipToMeasure = true;
+}
 
-            gifBuffer = handleDownloadGIFResponse(http, gifSize);
-            gifBufferSize = gifSize;
-            http.end();
-            return gifBuffer != nullptr;
+void NetworkManager::reportFlipError()
+{
+    if (flipProbeRunning)
+    {
+        if (timeSync.isPolling())
+        {
+            return;
         }
-        else
+        flipProbeRunning = false;
+        
+        // The clock was offsetUs behind NTP, so the flip happened that much later in NTP time
+        int64_t offsetUs;
+        if (!timeSync.takeProbeOffset(&offsetUs))
         {
-            SERIAL_PRINTLN("Failed to download GIF");
-            http.end();
-            return false;
+            SERIAL_PRINTLN("Flip error: no NTP reply to compare with");
+            return;
         }
+        int32_t localUs = flipErrorUs;
+        SERIAL_PRINT("Flip error: ");
+        SERIAL_PRINT(String(localUs / 1000.0, 2).c_str());
+        SERIAL_PRINT(" ms on the local clock, clock offset ");
+        SERIAL_PRINT(String(offsetUs / 1000.0, 2).c_str());
+        SERIAL_PRINT(" ms, ");
+        SERIAL_PRINT(String((localUs + offsetUs) / 1000.0, 2).c_str());
+        SERIAL_PRINTLN(" ms after the boundary in NTP time");
+        return;
     }
-    else
+    
+    if (flipToMeasure && timeSync.startProbe())
     {
-        SERIAL_PRINTLN("WiFi not connected");
-        return false;
+        flipToMeasure = false;
+        flipProbeRunning = true;
     }
 }
 
-uint8_t *NetworkManager::handleDownloadGIFResponse(HTTPClient &http, int gifSize)
+struct tm NetworkManager::getLocalTimeStruct()
 {
-    WiFiClient *stream = http.getStreamPtr();
-
-    if (gifSize > 0)
+    struct tm timeinfo;
+    if (getLocalTime(&timeinfo))
     {
-        SERIAL_PRINTLN("Downloading GIF...");
-
-        uint8_t *buffer = (uint8_t *)malloc(gifSize);
-        if (buffer == nullptr)
-        {
-            SERIAL_PRINTLN("Memory allocation failed for GIF");
-            return nullptr;
-        }
-
-        int bytesRead = 0;
-        while (http.connected() && stream->available() > 0 && bytesRead < gifSize)
-        {
-            int byte = stream->read();
-            buffer[bytesRead++] = byte;
-        }
-
-        SERIAL_PRINTLN("GIF downloaded and stored in memory");
-        return buffer;
+        return timeinfo;
     }
     else
     {
-        SERIAL_PRINTLN("No data available for GIF");
-        return nullptr;
+        memset(&timeinfo, 0, sizeof(struct tm));
+        SERIAL_PRINTLN("Failed to obtain local time");
+        return timeinfo;
     }
 }
 
-uint8_t *NetworkManager::getGifBuffer()
-{
-    return gifBuffer;
-}
-
-size_t NetworkManager::getGifBufferSize()
-{
-    return gifBufferSize;
-}
-
 // Static callback functions for WebConfigServer
 void NetworkManager::onWebSaveConfig(String ssid, String password, String tzString)
 {
@@ -900,6 +1068,14 @@ void NetworkManager::onWebSaveConfig(String ssid, String password, String tzStri
     }
 }
 
+void NetworkManager::onWebSaveNtpServers(String servers)
+{
+    if (instance)
+    {
+        instance->saveNtpServers(servers);
+    }
+}
+
 String NetworkManager::onWebGetNetworks()
 {
     if (instance)
@@ -968,60 +1144,21 @@ String NetworkManager::onWebGetTimezoneSettings()
     return "{\"error\":\"No instance\"}";
 }
 
-void NetworkManager::onWebTriggerGif()
-{
-    if (instance && instance->triggerGifCallback)
-    {
-        SERIAL_PRINTLN("GIF trigger requested from web");
-        instance->triggerGifCallback();
-    }
-}
-
-void NetworkManager::onWebTriggerWordsTest()
+void NetworkManager::setDisplayCommandQueue(DisplayCommandQueue *queue)
 {
-    if (instance && instance->triggerWordsTestCallback)
-    {
-        SERIAL_PRINTLN("Words test requested from web");
-        instance->triggerWordsTestCallback();
-    }
-}
-
-void NetworkManager::onWebTriggerLedTest()
-{
-    if (instance && instance->triggerLedTestCallback)
-    {
-        SERIAL_PRINTLN("LED test requested from web");
-        instance->triggerLedTestCallback();
-    }
-}
-
-void NetworkManager::onWebResumeNormal()
-{
-    if (instance && instance->resumeNormalCallback)
-    {
-        SERIAL_PRINTLN("Resume normal requested from web");
-        instance->resumeNormalCallback();
-    }
+    displayCommands = queue;
 }
 
-void NetworkManager::setTriggerGifCallback(void (*callback)())
+void NetworkManager::setTimeCache(TimeCache *cache)
 {
-    triggerGifCallback = callback;
+    timeCache = cache;
 }
 
-void NetworkManager::setTriggerWordsTestCallback(void (*callback)())
+void NetworkManager::applyStoredTimezone()
 {
-    triggerWordsTestCallback = callback;
-}
-
-void NetworkManager::setTriggerLedTestCallback(void (*callback)())
-{
-    triggerLedTestCallback = callback;
-}
-
-void NetworkManager::setResumeNormalCallback(void (*callback)())
-{
-    resumeNormalCallback = callback;
+    loadTimezoneSettings();
+    setenv("TZ", tzString.c_str(), 1);
+    tzset();
 }
 
 String NetworkManager::getStatusJSON()
@@ -1033,6 +1170,7 @@ String NetworkManager::getStatusJSON()
     json += "\"ssid\":\"" + WiFi.SSID() + "\",";
     json += "\"rssi\":" + String(WiFi.RSSI()) + ",";
     json += "\"ip\":\"" + WiFi.localIP().toString() + "\",";
+    json += "\"wifiState\":\"" + String(WiFiStateMachine::stateName(connection.getState())) + "\",";
     
     // Time info
     struct tm timeinfo = getLocalTimeStruct();
@@ -1051,6 +1189,18 @@ String NetworkManager::getStatusJSON()
     // Timezone info
     json += "\"timezone\":\"" + tzString + "\",";
     
+    // Clock discipline, as the network task last published it
+    NtpStatus status;
+    portENTER_CRITICAL(&ntpStatusLock);
+    status = ntpStatus;
+    portEXIT_CRITICAL(&ntpStatusLock);
+    json += "\"ntpSynced\":" + String(status.synced ? "true" : "false") + ",";
+    json += "\"ntpOffsetMs\":" + String(status.offsetMs) + ",";
+    json += "\"driftPpm\":" + String(status.driftPpb / 1000.0, 2) + ",";
+    json += "\"syncIntervalMin\":" + String(status.intervalMs / 60000) + ",";
+    json += "\"ntpServer\":\"" + String(status.source < 0 ? "" : status.servers[status.source].host) + "\",";
+    json += "\"ntpServers\":" + getNtpServersJSON(status) + ",";
+    
     // Uptime
     unsigned long uptimeSeconds = millis() / 1000;
     unsigned long days = uptimeSeconds / 86400;
@@ -1066,11 +1216,33 @@ String NetworkManager::getStatusJSON()
     return json;
 }
 
+// Per-server results of the last poll
+String NetworkManager::getNtpServersJSON(const NtpStatus &status)
+{
+    String json = "[";
+    for (uint8_t i = 0; i < status.serverCount; i++)
+    {
+        const auto &server = status.servers[i];
+        if (i > 0)
+        {
+            json += ",";
+        }
+        json += "{\"host\":\"" + String(server.host) + "\",";
+        json += "\"healthy\":" + String(server.healthy ? "true" : "false") + ",";
+        json += "\"rttMs\":" + String(server.rttUs / 1000.0, 1) + ",";
+        json += "\"offsetMs\":" + String(server.offsetUs / 1000.0, 1) + ",";
+        json += "\"stratum\":" + String(server.stratum) + "}";
+    }
+    json += "]";
+    return json;
+}
+
 String NetworkManager::getTimezoneSettingsJSON()
 {
     SERIAL_PRINTLN("Building timezone settings JSON...");
     String json = "{";
-    json += "\"tzString\":\"" + tzString + "\"";
+    json += "\"tzString\":\"" + tzString + "\",";
+    json += "\"ntpServers\":\"" + readNtpServers() + "\""; // Includes a save waiting for the reboot
     json += "}";
     SERIAL_PRINT("Timezone settings JSON: ");
     SERIAL_PRINTLN(json.c_str());
@@ -1098,9 +1270,7 @@ void NetworkManager::startNormalModeWebServer()
     webConfigServer->onStartScan(onWebStartScan);
     webConfigServer->onGetStatus(onWebGetStatus);
     webConfigServer->onGetTimezoneSettings(onWebGetTimezoneSettings); // NEW: timezone settings
-    webConfigServer->onTriggerGif(onWebTriggerGif);
-    webConfigServer->onTriggerWordsTest(onWebTriggerWordsTest);
-    webConfigServer->onTriggerLedTest(onWebTriggerLedTest);
-    webConfigServer->onResumeNormal(onWebResumeNormal);
+    webConfigServer->onSaveNtpServers(onWebSaveNtpServers);
+    webConfigServer->setDisplayCommandQueue(displayCommands);
     webConfigServer->start(WiFi.localIP(), MODE_NORMAL);
 }
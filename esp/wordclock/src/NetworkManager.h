@@ -6,6 +6,30 @@
 #include <HTTPClient.h>
 #include <Preferences.h>
 #include "WebConfigServer.h"
+#include "TimeCache.h"
+#include "TimeSync.h"
+#include "AnimationStore.h"
+#include "WiFiStateMachine.h"
+#include "SpscQueue.h"
+#include <atomic>
+
+// Posted by the network task to the render task (see main.cpp)
+enum NetworkEventType : uint8_t
+{
+    NET_EVENT_DISCONNECTED, // Waiting for WiFi
+    NET_EVENT_CONNECTED,    // Station mode
+    NET_EVENT_AP_MODE,      // Configuration access point running
+    NET_EVENT_GIF_READY,    // Animation on flash decoded, see animation
+    NET_EVENT_TIME_SYNCED   // NTP set the clock, the next flip may have moved
+};
+
+struct GifAnimation;
+
+struct NetworkEvent
+{
+    NetworkEventType type;
+    GifAnimation *animation; // NET_EVENT_GIF_READY: owned by the render task from here
+};
 
 class NetworkManager
 {
@@ -13,40 +37,53 @@ public:
     NetworkManager(long defaultGmtOffset_sec, int defaultDaylightOffset_sec);
     void setup();
     void update();
+    void updateTimeSync(); // Drift correction between NTP syncs, call once a minute
+    bool takeTimeSynced(); // True once after each NTP sync
+    bool isTimeSyncPolling(); // Waiting for NTP replies: call update() every millisecond or so
+    TimeSource *getTimeSource() { return &syncedTime; } // Millisecond clock with the drift model applied
+
+    // Flip error measurement (any task): the network task asks NTP how far the
+    // clock was off and logs the flip error relative to NTP time
+    void measureFlip(int32_t localErrorUs);
     struct tm getLocalTimeStruct();
-    bool downloadGIF(const char *gifUrl);
-    uint8_t *getGifBuffer();
-    size_t getGifBufferSize();
+    AnimationStore &getAnimationStore() { return animationStore; } // Hourly GIF on flash
     bool isConnected();
     bool isInAPMode();
     void clearAllSettings();
     void setResetButtonPin(int pin);
-    bool checkResetButton();
+    bool checkResetButton(); // True once the button has been held for 3 s; only detects
+    void requestReset(); // Any task: the network task clears all settings and restarts
     
-    // Set display control callbacks
-    void setTriggerGifCallback(void (*callback)());
-    void setTriggerWordsTestCallback(void (*callback)());
-    void setTriggerLedTestCallback(void (*callback)());
-    void setResumeNormalCallback(void (*callback)());
+    // Queue the web UI posts display commands to
+    void setDisplayCommandQueue(DisplayCommandQueue *queue);
+
+    // Told about every NTP sync so the time survives a warm reboot
+    void setTimeCache(TimeCache *cache);
+
+    // Sets TZ from flash so a restored clock shows local time before NTP
+    void applyStoredTimezone();
+    const char *getTimezone() { return tzString.c_str(); }
+
+    static const char *DEFAULT_NTP_SERVERS;
 
 private:
     String tzString; // POSIX TZ string with automatic DST support
+    String ntpServers; // Comma separated, preferred first; network task only
     long gmtOffset_sec; // Deprecated but kept for backward compatibility
     int daylightOffset_sec; // Deprecated but kept for backward compatibility
     long defaultGmtOffset_sec;
     int defaultDaylightOffset_sec;
-    unsigned long lastSyncTime;
-    unsigned long lastConnectionAttempt;
     unsigned long apModeStartTime;
-    const unsigned long syncInterval = 86400000;
-    const unsigned long connectionTimeout = 20000; // 20 seconds
-    const unsigned long retryInterval = 60000; // 1 minute retry
     const unsigned long apModeTimeout = 600000; // 10 minutes (600 seconds)
     
-    uint8_t *gifBuffer = nullptr;
-    size_t gifBufferSize = 0;
+    // Station connection: WiFi event task -> linkEvents -> connection
+    WiFiStateMachine connection;
+    SpscQueue<WiFiLinkEvent, 8> linkEvents;
+    bool usingConnectionCache; // Current attempt targets the cached BSSID/channel
+    bool usingCachedLease; // ...and reuses the cached DHCP address (WIFI_REUSE_DHCP_LEASE)
     
     Preferences preferences;
+    AnimationStore animationStore;
     WebConfigServer *webConfigServer;
     bool apModeActive;
     
@@ -59,22 +96,64 @@ private:
     unsigned long lastScanTime;
     unsigned long scanStartTime;
     int scanRetryCount;
+    bool setupScanStarted; // Setup AP: first scan issued
+    bool setupServerPending; // Setup AP: web server waits for the first scan
     
     // Reset button state
     int resetButtonPin;
     unsigned long buttonPressStart;
     bool buttonPressed;
+    std::atomic<bool> resetRequested;
+
+    // NTP state as of the last poll, published by the network task for the web server
+    struct NtpStatus
+    {
+        bool synced;
+        int32_t offsetMs;
+        int32_t driftPpb;
+        uint32_t intervalMs;
+        int8_t source; // Server of the last sync, -1 before the first
+        uint8_t serverCount;
+        struct
+        {
+            char host[NtpLookup::MAX_NAME_LENGTH];
+            bool healthy;
+            int32_t rttUs;
+            int64_t offsetUs;
+            uint8_t stratum;
+        } servers[NtpClient::MAX_SERVERS];
+    };
 
-    void syncTimeWithNTP();
-    uint8_t *handleDownloadGIFResponse(HTTPClient &http, int gifSize);
+    TimeSync timeSync;
+    SyncedTimeSource syncedTime;
+    NtpStatus ntpStatus;
+    portMUX_TYPE ntpStatusLock;
+    bool timeSyncedEvent;
+    std::atomic<bool> flipToMeasure;
+    std::atomic<int32_t> flipErrorUs;
+    bool flipProbeRunning;
+    void startTimeSync();
+    void processTimeSync();
+    void publishNtpStatus();
+    void reportFlipError();
     
     // WiFi Manager functions
     bool loadCredentials();
-    void saveCredentials(String ssid, String password);
+    static void saveCredentials(String ssid, String password); // Flash only, used from the next boot
     bool loadTimezoneSettings();
-    void saveTimezoneSettings(String tzString);
-    bool connectToWiFi();
+    static void saveTimezoneSettings(String tzString); // Flash only, used from the next boot
+    void loadNtpServers();
+    static String readNtpServers(); // From flash, safe on any task
+    static void saveNtpServers(String servers); // Flash only, used from the next boot
+    void beginConnection();
+    void applyConnectionAction(WiFiAction action);
+    void onConnected();
+    static void onWiFiEvent(arduino_event_id_t event);
+    bool loadConnectionCache(uint8_t *bssid, uint8_t *channel);
+    void saveConnectionCache();
+    void clearConnectionCache();
     void startAPMode();
+    void updateAPSetup();
     void startNetworkScan();
     String buildNetworksJSON(int numNetworks);
     String getNetworksJSON();
@@ -85,22 +164,17 @@ private:
     static void onWebStartScan();
     static String onWebGetStatus();
     static String onWebGetTimezoneSettings();
-    static void onWebTriggerGif();
-    static void onWebTriggerWordsTest();
-    static void onWebTriggerLedTest();
-    static void onWebResumeNormal();
+    static void onWebSaveNtpServers(String servers);
     
     String getStatusJSON();
     String getTimezoneSettingsJSON(); // New
+    String getNtpServersJSON(const NtpStatus &status);
     void startNormalModeWebServer();
     
     static NetworkManager* instance; // For static callbacks
     
-    // Display control callback pointers
-    void (*triggerGifCallback)();
-    void (*triggerWordsTestCallback)();
-    void (*triggerLedTestCallback)();
-    void (*resumeNormalCallback)();
+    DisplayCommandQueue *displayCommands;
+    TimeCache *timeCache;
 };
 
 #endif
@@ -0,0 +1,461 @@
+#include "NtpClient.h"
+#include "SerialHelper.h"
+#include "esp_timer.h"
+#include "lwip/dns.h"
+#include "lwip/tcpip.h"
+#include <sys/time.h>
+
+static const uint8_t NTP_PACKET_SIZE = 48;
+static const uint64_t NTP_UNIX_OFFSET = 2208988800ULL; // Seconds from 1900 to 1970
+
+static int64_t wallClockUs()
+{
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+}
+
+static uint64_t toNtpStamp(int64_t unixUs)
+{
+    uint64_t seconds = (uint64_t)(unixUs / 1000000) + NTP_UNIX_OFFSET;
+    uint64_t fraction = ((uint64_t)(unixUs % 1000000) << 32) / 1000000;
+    return (seconds << 32) | (fraction & 0xFFFFFFFF);
+}
+
+static int64_t fromNtpStamp(uint64_t stamp)
+{
+    int64_t seconds = (int64_t)(stamp >> 32);
+    if (seconds < 0x80000000LL)
+    {
+        seconds += 0x100000000LL; // Era 1, after February 2036
+    }
+    int64_t fractionUs = (int64_t)(((stamp & 0xFFFFFFFF) * 1000000) >> 32);
+    return (seconds - (int64_t)NTP_UNIX_OFFSET) * 1000000 + fractionUs;
+}
+
+static uint64_t readStamp(const uint8_t *p)
+{
+    uint64_t stamp = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        stamp = (stamp << 8) | p[i];
+    }
+    return stamp;
+}
+
+static void writeStamp(uint8_t *p, uint64_t stamp)
+{
+    for (int i = 7; i >= 0; i--)
+    {
+        p[i] = stamp & 0xFF;
+        stamp >>= 8;
+    }
+}
+
+// lwIP thread: publish a lookup result unless the server list changed meanwhile
+static void finishLookup(NtpLookup *lookup, const ip_addr_t *address)
+{
+    portENTER_CRITICAL(lookup->lock);
+    if (lookup->startedGeneration != lookup->generation)
+    {
+        lookup->state = NtpLookup::IDLE;
+    }
+    else if (address && IP_IS_V4(address) && ip_2_ip4(address)->addr != 0)
+    {
+        lookup->address = ip_2_ip4(address)->addr;
+        lookup->state = NtpLookup::FOUND;
+    }
+    else
+    {
+        lookup->state = NtpLookup::FAILED;
+    }
+    portEXIT_CRITICAL(lookup->lock);
+}
+
+static void onLookupDone(const char *, const ip_addr_t *address, void *arg)
+{
+    finishLookup((NtpLookup *)arg, address);
+}
+
+// lwIP thread: answers from the DNS cache right away, otherwise through onLookupDone
+static void runLookup(void *arg)
+{
+    NtpLookup *lookup = (NtpLookup *)arg;
+    ip_addr_t address;
+    err_t err = dns_gethostbyname(lookup->name, &address, onLookupDone, lookup);
+    if (err == ERR_OK)
+    {
+        finishLookup(lookup, &address);
+    }
+    else if (err != ERR_INPROGRESS)
+    {
+        finishLookup(lookup, nullptr);
+    }
+}
+
+NtpClient::NtpClient()
+    : socketOpen(false), serverCount(0), polling(false), pending(0), pollStartMs(0), lookups(),
+      lookupLock(portMUX_INITIALIZER_UNLOCKED)
+{
+    for (uint8_t i = 0; i < MAX_SERVERS; i++)
+    {
+        lookups[i].lock = &lookupLock;
+    }
+}
+
+NtpClient::~NtpClient()
+{
+    for (uint8_t i = 0; i < MAX_SERVERS; i++)
+    {
+        for (;;)
+        {
+            portENTER_CRITICAL(&lookupLock);
+            bool running = lookups[i].state == NtpLookup::RUNNING;
+            portEXIT_CRITICAL(&lookupLock);
+            if (!running)
+            {
+                break;
+            }
+            delay(1);
+        }
+    }
+}
+
+void NtpClient::setServers(const String &list)
+{
+    serverCount = 0;
+    polling = false;
+
+    // A lookup still running finishes, but its answer belongs to the old list
+    portENTER_CRITICAL(&lookupLock);
+    for (uint8_t i = 0; i < MAX_SERVERS; i++)
+    {
+        lookups[i].generation++;
+        if (lookups[i].state != NtpLookup::RUNNING)
+        {
+            lookups[i].state = NtpLookup::IDLE;
+        }
+    }
+    portEXIT_CRITICAL(&lookupLock);
+
+    int start = 0;
+    while (start <= (int)list.length() && serverCount < MAX_SERVERS)
+    {
+        int comma = list.indexOf(',', start);
+        if (comma < 0)
+        {
+            comma = list.length();
+        }
+        String entry = list.substring(start, comma);
+        entry.trim();
+        start = comma + 1;
+        if (entry.length() == 0)
+        {
+            continue;
+        }
+
+        NtpServer &server = servers[serverCount++];
+        server = NtpServer();
+        server.port = NTP_PORT;
+        int colon = entry.indexOf(':');
+        if (colon > 0)
+        {
+            server.port = entry.substring(colon + 1).toInt();
+            entry = entry.substring(0, colon);
+        }
+        server.host = entry;
+    }
+}
+
+bool NtpClient::resolve(uint8_t index)
+{
+    NtpServer &server = servers[index];
+    server.resolving = false;
+    if (server.address.fromString(server.host.c_str()))
+    {
+        return true;
+    }
+
+    NtpLookup &lookup = lookups[index];
+    portENTER_CRITICAL(&lookupLock);
+    NtpLookup::State state = lookup.state;
+    uint32_t address = lookup.address;
+    if (state == NtpLookup::FOUND || state == NtpLookup::FAILED)
+    {
+        lookup.state = NtpLookup::IDLE;
+    }
+    portEXIT_CRITICAL(&lookupLock);
+
+    switch (state)
+    {
+    case NtpLookup::FOUND:
+        server.address = IPAddress(address);
+        server.resolveSkips = 0;
+        return true;
+
+    case NtpLookup::FAILED:
+        server.resolveSkips = RESOLVE_RETRY_POLLS;
+        SERIAL_PRINT("NTP: cannot resolve ");
+        SERIAL_PRINTLN(server.host.c_str());
+        return false;
+
+    case NtpLookup::RUNNING:
+        server.resolving = true;
+        return false;
+
+    default:
+        break;
+    }
+
+    // A dead name would otherwise cost a DNS timeout on every poll
+    if (server.resolveSkips > 0)
+    {
+        server.resolveSkips--;
+        return false;
+    }
+    server.resolving = startLookup(index);
+    return false;
+}
+
+bool NtpClient::startLookup(uint8_t index)
+{
+    NtpServer &server = servers[index];
+    NtpLookup &lookup = lookups[index];
+    if (server.host.length() >= NtpLookup::MAX_NAME_LENGTH)
+    {
+        SERIAL_PRINT("NTP: host name too long: ");
+        SERIAL_PRINTLN(server.host.c_str());
+        server.resolveSkips = RESOLVE_RETRY_POLLS;
+        return false;
+    }
+
+    // Not RUNNING, so the lwIP thread does not touch the slot until we queue it
+    strcpy(lookup.name, server.host.c_str());
+    portENTER_CRITICAL(&lookupLock);
+    lookup.startedGeneration = lookup.generation;
+    lookup.state = NtpLookup::RUNNING;
+    portEXIT_CRITICAL(&lookupLock);
+
+    if (tcpip_callback(runLookup, &lookup) != ERR_OK)
+    {
+        portENTER_CRITICAL(&lookupLock);
+        lookup.state = NtpLookup::IDLE;
+        portEXIT_CRITICAL(&lookupLock);
+        return false;
+    }
+    return true;
+}
+
+void NtpClient::sendRequest(NtpServer &server)
+{
+    uint8_t packet[NTP_PACKET_SIZE] = {};
+    packet[0] = 0x23; // LI 0, version 4, mode 3 (client)
+    server.requestMonoUs = esp_timer_get_time();
+    server.requestWallUs = wallClockUs();
+    server.requestStamp = toNtpStamp(server.requestWallUs);
+    writeStamp(packet + 40, server.requestStamp); // Transmit timestamp
+
+    if (udp.beginPacket(server.address, server.port) == 1 &&
+        udp.write(packet, sizeof(packet)) == sizeof(packet) && udp.endPacket() == 1)
+    {
+        server.awaiting = true;
+        pending++;
+    }
+    else
+    {
+        server.misses++;
+    }
+}
+
+bool NtpClient::startPoll()
+{
+    if (!socketOpen)
+    {
+        socketOpen = udp.begin(LOCAL_PORT) == 1;
+        if (!socketOpen)
+        {
+            SERIAL_PRINTLN("NTP: cannot open UDP socket");
+            return false;
+        }
+    }
+
+    // Drop stray replies to an earlier poll
+    while (udp.parsePacket() > 0)
+    {
+    }
+
+    pending = 0;
+    for (uint8_t i = 0; i < serverCount; i++)
+    {
+        NtpServer &server = servers[i];
+        server.awaiting = false;
+        server.healthy = false;
+        if ((uint32_t)server.address == 0 && !resolve(i))
+        {
+            if (server.resolving)
+            {
+                pending++; // Sent from update() once the address is in
+            }
+            else
+            {
+                server.misses++;
+            }
+            continue;
+        }
+        sendRequest(server);
+    }
+
+    polling = pending > 0;
+    pollStartMs = millis();
+    return polling;
+}
+
+bool NtpClient::update()
+{
+    if (!polling)
+    {
+        return false;
+    }
+
+    // Servers whose address came in since the last call
+    for (uint8_t i = 0; i < serverCount; i++)
+    {
+        NtpServer &server = servers[i];
+        if (!server.resolving)
+        {
+            continue;
+        }
+        bool known = resolve(i);
+        if (server.resolving)
+        {
+            continue;
+        }
+        pending--;
+        if (known)
+        {
+            sendRequest(server);
+        }
+        else
+        {
+            server.misses++;
+        }
+    }
+
+    int size;
+    while ((size = udp.parsePacket()) > 0)
+    {
+        int64_t monoUs = esp_timer_get_time(); // Arrival is only as exact as our polling
+        uint8_t packet[NTP_PACKET_SIZE];
+        int length = udp.read(packet, sizeof(packet));
+        handleReply(packet, length, udp.remoteIP(), udp.remotePort(), monoUs);
+    }
+
+    if (pending > 0 && millis() - pollStartMs < REPLY_TIMEOUT_MS)
+    {
+        return false;
+    }
+    finishPoll();
+    return true;
+}
+
+void NtpClient::handleReply(const uint8_t *packet, int size, IPAddress from, uint16_t fromPort, int64_t monoUs)
+{
+    NtpServer *server = nullptr;
+    for (uint8_t i = 0; i < serverCount; i++)
+    {
+        if (servers[i].awaiting && servers[i].address == from && servers[i].port == fromPort)
+        {
+            server = &servers[i];
+            break;
+        }
+    }
+    // The echoed timestamp proves this answers our request and not an older one
+    if (!server || size < NTP_PACKET_SIZE || readStamp(packet + 24) != server->requestStamp)
+    {
+        return;
+    }
+    server->awaiting = false;
+    pending--;
+
+    uint8_t leap = packet[0] >> 6;
+    uint8_t mode = packet[0] & 0x07;
+    server->stratum = packet[1];
+    uint64_t receiveStamp = readStamp(packet + 32);
+    uint64_t transmitStamp = readStamp(packet + 40);
+    // Stratum 0 is a kiss-o'-death, leap 3 an unsynchronised server
+    if (mode != 4 || leap == 3 || server->stratum == 0 || server->stratum > 15 || transmitStamp == 0)
+    {
+        server->misses++;
+        return;
+    }
+
+    // t1/t4 on our clock, t2/t3 on the server's; the oscillator times the round trip
+    int64_t t1 = server->requestWallUs;
+    int64_t t2 = fromNtpStamp(receiveStamp);
+    int64_t t3 = fromNtpStamp(transmitStamp);
+    int64_t t4 = t1 + (monoUs - server->requestMonoUs);
+    server->offsetUs = ((t2 - t1) + (t3 - t4)) / 2;
+    int64_t rttUs = (t4 - t1) - (t3 - t2);
+    server->rttUs = (int32_t)(rttUs < 0 ? 0 : rttUs);
+    server->replyWallUs = t4;
+    server->replyMonoUs = monoUs;
+    server->healthy = true;
+    server->misses = 0;
+}
+
+void NtpClient::finishPoll()
+{
+    polling = false;
+    for (uint8_t i = 0; i < serverCount; i++)
+    {
+        NtpServer &server = servers[i];
+        if (server.awaiting || server.resolving)
+        {
+            // A lookup keeps running and is picked up by the next poll
+            server.awaiting = false;
+            server.resolving = false;
+            server.misses++;
+        }
+        if (server.misses >= RESOLVE_AFTER_MISSES)
+        {
+            server.address = IPAddress();
+        }
+
+        SERIAL_PRINT("NTP ");
+        SERIAL_PRINT(server.host.c_str());
+        if (server.port != NTP_PORT)
+        {
+            SERIAL_PRINT(":");
+            SERIAL_PRINT(String(server.port).c_str());
+        }
+        if (server.healthy)
+        {
+            SERIAL_PRINT(": rtt ");
+            SERIAL_PRINT(String(server.rttUs / 1000.0, 1).c_str());
+            SERIAL_PRINT(" ms, offset ");
+            SERIAL_PRINT(String(server.offsetUs / 1000.0, 1).c_str());
+            SERIAL_PRINT(" ms, stratum ");
+            SERIAL_PRINTLN(String(server.stratum).c_str());
+        }
+        else
+        {
+            SERIAL_PRINT(": no usable reply (");
+            SERIAL_PRINT(String(server.misses).c_str());
+            SERIAL_PRINTLN(" in a row)");
+        }
+    }
+}
+
+int8_t NtpClient::getBestServer()
+{
+    int8_t best = -1;
+    for (uint8_t i = 0; i < serverCount; i++)
+    {
+        // Strictly faster only, so a tie goes to the server listed first
+        if (servers[i].healthy && (best < 0 || servers[i].rttUs < servers[best].rttUs))
+        {
+            best = i;
+        }
+    }
+    return best;
+}
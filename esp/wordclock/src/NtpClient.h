@@ -0,0 +1,99 @@
+#ifndef NTP_CLIENT_H
+#define NTP_CLIENT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+// One configured NTP server and what its last reply told us
+struct NtpServer
+{
+    String host;       // Name or dotted IP as configured
+    uint16_t port;
+    IPAddress address; // 0.0.0.0 until resolved
+    bool healthy;      // Gave a usable reply in the last poll
+    uint8_t misses;    // Polls in a row without a usable reply
+    uint8_t resolveSkips; // Polls left before a name that failed to resolve is tried again
+    uint8_t stratum;
+    int32_t rttUs;     // Round trip minus the server's own processing time
+    int64_t offsetUs;  // Server minus local clock
+    int64_t replyWallUs; // Local clock and esp_timer when the reply came in
+    int64_t replyMonoUs;
+
+    // Request in flight
+    bool resolving; // This poll sends as soon as the lookup comes back
+    bool awaiting;
+    uint64_t requestStamp; // NTP timestamp we sent, the server echoes it back
+    int64_t requestWallUs;
+    int64_t requestMonoUs;
+};
+
+// Host name lookup for one server, run by lwIP on its own thread. state,
+// address and the generations are shared with that thread under *lock.
+struct NtpLookup
+{
+    enum State : uint8_t
+    {
+        IDLE,
+        RUNNING,
+        FOUND,
+        FAILED
+    };
+    static const uint8_t MAX_NAME_LENGTH = 64;
+
+    portMUX_TYPE *lock;
+    char name[MAX_NAME_LENGTH];
+    uint8_t generation;        // Bumped when the server list changes
+    uint8_t startedGeneration; // An answer for an older list is dropped
+    State state;
+    uint32_t address;          // Network byte order, valid in FOUND
+};
+
+// SNTP client that asks every configured server at once from one UDP socket.
+// A dead server costs REPLY_TIMEOUT_MS at most and never holds up the others;
+// the caller picks the fastest healthy one when the poll is over. Nothing
+// here blocks: names are looked up on the lwIP thread and a server's request
+// goes out once its address is known. A name that does not resolve sits out
+// RESOLVE_RETRY_POLLS polls before it is looked up again.
+class NtpClient
+{
+public:
+    static const uint8_t MAX_SERVERS = 4;
+    static const uint16_t NTP_PORT = 123;
+    static const uint16_t LOCAL_PORT = 4123;
+    static const uint32_t REPLY_TIMEOUT_MS = 1500;
+    static const uint8_t RESOLVE_AFTER_MISSES = 3; // Pool names rotate, look them up again
+    static const uint8_t RESOLVE_RETRY_POLLS = 8;
+
+    NtpClient();
+    ~NtpClient(); // Waits for lookups still running on the lwIP thread
+
+    // "host[:port],host[:port],..." in order of preference
+    void setServers(const String &list);
+    uint8_t getServerCount() { return serverCount; }
+    const NtpServer &getServer(uint8_t index) { return servers[index]; }
+
+    bool startPoll();  // Sends the requests, false if none could go out
+    bool update();     // Collects replies, true once when the poll is over
+    bool isPolling() { return polling; }
+    int8_t getBestServer(); // Healthy server with the lowest RTT, -1 if none answered
+
+private:
+    WiFiUDP udp;
+    bool socketOpen;
+    NtpServer servers[MAX_SERVERS];
+    uint8_t serverCount;
+    bool polling;
+    uint8_t pending; // Requests of this poll still unanswered
+    unsigned long pollStartMs;
+    NtpLookup lookups[MAX_SERVERS]; // Same index as servers
+    portMUX_TYPE lookupLock;
+
+    bool resolve(uint8_t index); // True once the address is known, sets resolving while a lookup runs
+    bool startLookup(uint8_t index);
+    void sendRequest(NtpServer &server);
+    void handleReply(const uint8_t *packet, int size, IPAddress from, uint16_t fromPort, int64_t monoUs);
+    void finishPoll();
+};
+
+#endif
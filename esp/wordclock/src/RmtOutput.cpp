@@ -0,0 +1,122 @@
+#include "RmtOutput.h"
+#include "SerialHelper.h"
+
+// RMT clock = 80 MHz APB / 2 = 25 ns per tick
+#define RMT_CLK_DIV 2
+#define WS2812_T0H 14 // 0.35 us
+#define WS2812_T0L 34 // 0.85 us
+#define WS2812_T1H 28 // 0.70 us
+#define WS2812_T1L 24 // 0.60 us
+#define WS2812_RESET_HALF 6000 // 150 us; two make the >= 280 us low that latches a frame
+#define MAX_PREVIOUS_FRAME_WAIT_MS 10
+
+RmtOutput::RmtOutput(uint8_t pin, uint16_t numPixels, rmt_channel_t channel)
+    : pin(pin), numPixels(numPixels), channel(channel), nextBuffer(0), installed(false), transmitting(false)
+{
+    buffers[0] = nullptr;
+    buffers[1] = nullptr;
+}
+
+RmtOutput::~RmtOutput()
+{
+    if (installed)
+    {
+        rmt_driver_uninstall(channel);
+    }
+    free(buffers[0]);
+    free(buffers[1]);
+}
+
+void RmtOutput::begin()
+{
+    buffers[0] = (uint8_t *)calloc(numPixels * 3, 1);
+    buffers[1] = (uint8_t *)calloc(numPixels * 3, 1);
+    if (!buffers[0] || !buffers[1])
+    {
+        SERIAL_PRINTLN("RMT output: buffer allocation failed");
+        return;
+    }
+
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, channel);
+    config.clk_div = RMT_CLK_DIV;
+
+    if (rmt_config(&config) != ESP_OK || rmt_driver_install(channel, 0, 0) != ESP_OK)
+    {
+        SERIAL_PRINTLN("RMT output: driver install failed");
+        return;
+    }
+    rmt_translator_init(channel, translate);
+    installed = true;
+}
+
+// Expands each byte into 8 RMT items; runs from the RMT ISR as buffer memory frees up.
+// The last byte carries the reset low as well, so a transfer only counts as
+// done once the strip has latched and the next frame cannot run into it.
+void IRAM_ATTR RmtOutput::translate(const void *src, rmt_item32_t *dest, size_t srcSize,
+                                    size_t wantedNum, size_t *translatedSize, size_t *itemNum)
+{
+    const rmt_item32_t bit0 = {{{WS2812_T0H, 1, WS2812_T0L, 0}}};
+    const rmt_item32_t bit1 = {{{WS2812_T1H, 1, WS2812_T1L, 0}}};
+    const rmt_item32_t reset = {{{WS2812_RESET_HALF, 0, WS2812_RESET_HALF, 0}}};
+
+    const uint8_t *bytes = (const uint8_t *)src;
+    size_t size = 0;
+    size_t num = 0;
+    while (size < srcSize && num + (size + 1 == srcSize ? 9 : 8) <= wantedNum)
+    {
+        uint8_t value = bytes[size];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            dest[num++].val = (value & (0x80 >> bit)) ? bit1.val : bit0.val;
+        }
+        size++;
+        if (size == srcSize)
+        {
+            dest[num++].val = reset.val;
+        }
+    }
+    *translatedSize = size;
+    *itemNum = num;
+}
+
+bool RmtOutput::isBusy()
+{
+    return transmitting && rmt_wait_tx_done(channel, 0) != ESP_OK;
+}
+
+void RmtOutput::write(const uint32_t *pixels, uint16_t count)
+{
+    if (!installed)
+    {
+        return;
+    }
+    if (count > numPixels)
+    {
+        count = numPixels;
+    }
+
+    // Fill the buffer that is not on the wire
+    uint8_t *buffer = buffers[nextBuffer];
+    for (uint16_t i = 0; i < count; i++)
+    {
+        uint32_t c = pixels[i];
+        buffer[i * 3] = (uint8_t)(c >> 8);      // G
+        buffer[i * 3 + 1] = (uint8_t)(c >> 16); // R
+        buffer[i * 3 + 2] = (uint8_t)c;         // B
+    }
+
+    // Only one frame can be in flight; a frame and its reset take ~4 ms so this rarely waits
+    if (isBusy())
+    {
+        rmt_wait_tx_done(channel, pdMS_TO_TICKS(MAX_PREVIOUS_FRAME_WAIT_MS));
+    }
+
+    rmt_write_sample(channel, buffer, count * 3, false);
+    transmitting = true;
+    nextBuffer ^= 1;
+}
+
+const char *RmtOutput::getName()
+{
+    return "RMT";
+}
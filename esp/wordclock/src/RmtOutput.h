@@ -0,0 +1,33 @@
+#ifndef RMT_OUTPUT_H
+#define RMT_OUTPUT_H
+
+#include <driver/rmt.h>
+#include "LedOutput.h"
+
+// Non-blocking WS2812 output on the ESP32 RMT peripheral.
+// write() encodes into the idle half of a double buffer and queues it; the RMT
+// driver streams it out from its ISR while the caller keeps running.
+class RmtOutput : public LedOutput
+{
+public:
+    RmtOutput(uint8_t pin, uint16_t numPixels, rmt_channel_t channel = RMT_CHANNEL_0);
+    ~RmtOutput();
+    void begin() override;
+    void write(const uint32_t *pixels, uint16_t numPixels) override;
+    const char *getName() override;
+    bool isBusy();
+
+private:
+    uint8_t pin;
+    uint16_t numPixels;
+    rmt_channel_t channel;
+    uint8_t *buffers[2]; // GRB wire bytes, one being sent while the other is filled
+    uint8_t nextBuffer;
+    bool installed;
+    bool transmitting;
+
+    static void IRAM_ATTR translate(const void *src, rmt_item32_t *dest, size_t srcSize,
+                                    size_t wantedNum, size_t *translatedSize, size_t *itemNum);
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "Scheduler.h"
+#include <limits.h>
+#include "SerialHelper.h"
+
+Scheduler::Scheduler() : taskCount(0), wakeups(0), startMs(0) {}
+
+bool Scheduler::isValid(int taskId)
+{
+    return taskId >= 0 && taskId < taskCount;
+}
+
+int Scheduler::addTask(const char *name, TaskCallback callback, unsigned long periodMs, unsigned long deadlineMs)
+{
+    if (taskCount >= MAX_TASKS || !callback)
+    {
+        SERIAL_PRINTLN("Scheduler: cannot add task");
+        return -1;
+    }
+
+    if (taskCount == 0)
+    {
+        startMs = millis();
+    }
+
+    Task &task = tasks[taskCount];
+    task.name = name;
+    task.callback = callback;
+    task.periodMs = periodMs;
+    task.deadlineMs = deadlineMs ? deadlineMs : periodMs;
+    task.nextRun = millis(); // First run on the next run()
+    task.maxLateMs = 0;
+    task.maxRunMs = 0;
+    task.runs = 0;
+    task.missed = 0;
+    task.enabled = true;
+    return taskCount++;
+}
+
+void Scheduler::setPeriod(int taskId, unsigned long periodMs)
+{
+    if (isValid(taskId) && tasks[taskId].periodMs != periodMs)
+    {
+        tasks[taskId].periodMs = periodMs;
+        tasks[taskId].nextRun = millis() + periodMs;
+    }
+}
+
+void Scheduler::setEnabled(int taskId, bool enabled)
+{
+    if (!isValid(taskId) || tasks[taskId].enabled == enabled)
+        return;
+
+    tasks[taskId].enabled = enabled;
+    if (enabled)
+    {
+        tasks[taskId].nextRun = millis();
+    }
+}
+
+void Scheduler::runSoon(int taskId)
+{
+    if (isValid(taskId))
+    {
+        tasks[taskId].nextRun = millis();
+    }
+}
+
+void Scheduler::runAfter(int taskId, unsigned long delayMs)
+{
+    if (isValid(taskId))
+    {
+        tasks[taskId].nextRun = millis() + delayMs;
+    }
+}
+
+unsigned long Scheduler::run()
+{
+    wakeups++;
+    for (uint8_t i = 0; i < taskCount; i++)
+    {
+        Task &task = tasks[i];
+        unsigned long now = millis();
+        if (!task.enabled || (long)(now - task.nextRun) < 0)
+            continue;
+
+        unsigned long late = now - task.nextRun;
+        if (late > task.maxLateMs)
+            task.maxLateMs = late;
+        if (late > task.deadlineMs)
+            task.missed++;
+
+        const unsigned long scheduled = task.nextRun;
+        task.callback();
+        task.runs++;
+
+        unsigned long finished = millis();
+        if (finished - now > task.maxRunMs)
+            task.maxRunMs = finished - now;
+
+        // The callback may have rescheduled itself (setPeriod/runSoon); keep that
+        if (task.nextRun != scheduled)
+            continue;
+
+        // Fixed rate; if we fell a whole period behind, skip ahead instead of bursting
+        task.nextRun += task.periodMs;
+        if ((long)(finished - task.nextRun) >= 0)
+        {
+            task.nextRun = finished + task.periodMs;
+        }
+    }
+
+    unsigned long now = millis();
+    unsigned long idle = ULONG_MAX;
+    for (uint8_t i = 0; i < taskCount; i++)
+    {
+        if (!tasks[i].enabled)
+            continue;
+        long untilDue = (long)(tasks[i].nextRun - now);
+        if (untilDue <= 0)
+            return 0;
+        if ((unsigned long)untilDue < idle)
+            idle = untilDue;
+    }
+    return idle == ULONG_MAX ? 0 : idle;
+}
+
+void Scheduler::printStats()
+{
+    // Per hour: an idle render core only wakes for the five-minute flips
+    unsigned long elapsedMs = millis() - startMs;
+    SERIAL_PRINT("Scheduler wake-ups: ");
+    SERIAL_PRINT(String(wakeups).c_str());
+    if (elapsedMs > 0)
+    {
+        SERIAL_PRINT(" (");
+        SERIAL_PRINT(String(wakeups * 3600000.0 / elapsedMs, 1).c_str());
+        SERIAL_PRINT(" per hour)");
+    }
+    SERIAL_PRINTLN("");
+    SERIAL_PRINTLN("Scheduler tasks (period / runs / missed / max late / max run, ms):");
+    for (uint8_t i = 0; i < taskCount; i++)
+    {
+        const Task &task = tasks[i];
+        char line[96];
+        snprintf(line, sizeof(line), "  %-10s %6lu %8lu %6lu %6lu %6lu%s", task.name, task.periodMs,
+                 (unsigned long)task.runs, (unsigned long)task.missed, task.maxLateMs, task.maxRunMs,
+                 task.enabled ? "" : " (disabled)");
+        SERIAL_PRINTLN(line);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+typedef void (*TaskCallback)();
+
+// Cooperative scheduler for loop(): every task runs at its own fixed rate and
+// the caller sleeps until the next deadline instead of a global delay().
+class Scheduler
+{
+public:
+    static const uint8_t MAX_TASKS = 8;
+
+    Scheduler();
+
+    // deadlineMs: how late a run may start before it counts as missed (0 = one period)
+    int addTask(const char *name, TaskCallback callback, unsigned long periodMs, unsigned long deadlineMs = 0);
+    void setPeriod(int taskId, unsigned long periodMs);
+    void setEnabled(int taskId, bool enabled);
+    void runSoon(int taskId); // Make the task due on the next run()
+    void runAfter(int taskId, unsigned long delayMs); // One-off: next run in delayMs, then periodic again
+
+    // Runs every due task once, returns the milliseconds until the next one is due
+    unsigned long run();
+    void printStats();
+
+private:
+    struct Task
+    {
+        const char *name;
+        TaskCallback callback;
+        unsigned long periodMs;
+        unsigned long deadlineMs;
+        unsigned long nextRun;
+        unsigned long maxLateMs;
+        unsigned long maxRunMs;
+        uint32_t runs;
+        uint32_t missed;
+        bool enabled;
+    };
+
+    Task tasks[MAX_TASKS];
+    uint8_t taskCount;
+    uint32_t wakeups;     // run() calls, i.e. times the owning task woke up
+    unsigned long startMs;
+
+    bool isValid(int taskId);
+};
+
+#endif
@@ -3,6 +3,6 @@
 void initSerial()
 {
 #if USE_SERIAL
-    Serial.begin(9600);
+    Serial.begin(115200); // Boot logging blocks; at 9600 baud it cost more than the WiFi join
 #endif
 }
\ No newline at end of file
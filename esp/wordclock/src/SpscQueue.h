@@ -0,0 +1,52 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Bounded lock-free ring buffer for exactly one producer and one consumer task.
+// push() and pop() never block; a full queue rejects the item.
+template <typename T, uint8_t CAPACITY>
+class SpscQueue
+{
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    // Producer side
+    bool push(const T &item)
+    {
+        const uint8_t t = tail.load(std::memory_order_relaxed);
+        const uint8_t next = (t + 1) % SLOTS;
+        if (next == head.load(std::memory_order_acquire))
+            return false; // Full
+        items[t] = item;
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T &item)
+    {
+        const uint8_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false; // Empty
+        item = items[h];
+        head.store((h + 1) % SLOTS, std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    static const uint8_t SLOTS = CAPACITY + 1; // One slot stays free to tell full from empty
+    static_assert(CAPACITY > 0 && CAPACITY < 255, "SpscQueue capacity must be 1..254");
+
+    T items[SLOTS];
+    std::atomic<uint8_t> head; // Next slot to read, owned by the consumer
+    std::atomic<uint8_t> tail; // Next slot to write, owned by the producer
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include "TimeCache.h"
+#include "SerialHelper.h"
+#include "esp_system.h"
+#include <stddef.h>
+#include <sys/time.h>
+
+static const uint32_t RTC_MAGIC = 0x57434C4B;      // "WCLK"
+static const time_t MIN_VALID_EPOCH = 1483228800; // 2017-01-01, same cut-off as WordClock
+
+struct RtcTimeRecord
+{
+    uint32_t magic;
+    int64_t epochMs;  // Wall clock when saved
+    int32_t driftPpb; // Latest estimate; NVS only gets changes of a ppm or more
+    uint32_t checksum;
+};
+
+// Not zeroed on reset; garbage after power-on, hence magic and checksum
+RTC_NOINIT_ATTR static RtcTimeRecord rtcRecord;
+
+static uint32_t recordChecksum(const RtcTimeRecord &record)
+{
+    // FNV-1a over everything but the checksum itself
+    const uint8_t *bytes = (const uint8_t *)&record;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(RtcTimeRecord, checksum); i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static int64_t wallClockMs()
+{
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+TimeCache *TimeCache::instance = nullptr;
+
+TimeCache::TimeCache() : lastSyncEpoch(0), driftPpb(0), storedDriftPpb(0)
+{
+    instance = this;
+}
+
+void TimeCache::begin()
+{
+    preferences.begin("timecache", true); // Read-only
+    lastSyncEpoch = (time_t)preferences.getULong("lastSync", 0);
+    driftPpb = preferences.getLong("driftPpb", 0);
+    storedDriftPpb = driftPpb;
+    preferences.end();
+
+    // ESP.restart() runs shutdown handlers, so planned reboots lose no time at all
+    esp_register_shutdown_handler(saveOnShutdown);
+}
+
+bool TimeCache::restore()
+{
+    if (time(nullptr) >= MIN_VALID_EPOCH)
+    {
+        return false; // Clock already running (host builds, or kept by the RTC)
+    }
+    if (rtcRecord.magic != RTC_MAGIC || rtcRecord.checksum != recordChecksum(rtcRecord))
+    {
+        SERIAL_PRINTLN("No cached time in RTC memory (cold boot)");
+        return false;
+    }
+
+    // millis() covers the time since this boot started; the reset itself is not
+    // counted, and after a crash the snapshot can be up to a minute old
+    int64_t epochMs = rtcRecord.epochMs + millis();
+    struct timeval tv;
+    tv.tv_sec = (time_t)(epochMs / 1000);
+    tv.tv_usec = (suseconds_t)(epochMs % 1000) * 1000;
+    settimeofday(&tv, nullptr);
+
+    // Newer than the NVS copy whenever recordSync() skipped the flash write
+    driftPpb = rtcRecord.driftPpb;
+
+    SERIAL_PRINT("Restored time from RTC memory: ");
+    SERIAL_PRINTLN(String((unsigned long)tv.tv_sec).c_str());
+    return true;
+}
+
+void TimeCache::save()
+{
+    int64_t nowMs = wallClockMs();
+    if (nowMs / 1000 < MIN_VALID_EPOCH)
+    {
+        return; // Nothing worth keeping yet
+    }
+    rtcRecord.magic = RTC_MAGIC;
+    rtcRecord.epochMs = nowMs;
+    rtcRecord.driftPpb = driftPpb;
+    rtcRecord.checksum = recordChecksum(rtcRecord);
+}
+
+void TimeCache::recordSync(int32_t newDriftPpb)
+{
+    time_t now = time(nullptr);
+
+    // Syncs can come every 15 minutes; flash only needs a daily refresh or a
+    // drift change of a ppm or more
+    int32_t change = newDriftPpb > storedDriftPpb ? newDriftPpb - storedDriftPpb : storedDriftPpb - newDriftPpb;
+    if (change >= 1000 || now - lastSyncEpoch >= 86400)
+    {
+        preferences.begin("timecache", false); // Read-write
+        preferences.putULong("lastSync", (uint32_t)now);
+        preferences.putLong("driftPpb", newDriftPpb);
+        preferences.end();
+        lastSyncEpoch = now;
+        storedDriftPpb = newDriftPpb;
+    }
+    driftPpb = newDriftPpb;
+
+    save();
+}
+
+void TimeCache::saveOnShutdown()
+{
+    if (instance)
+    {
+        instance->save();
+    }
+}
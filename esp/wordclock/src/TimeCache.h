@@ -0,0 +1,33 @@
+#ifndef TIME_CACHE_H
+#define TIME_CACHE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+
+// Keeps the wall clock across warm reboots so the clock can show the time
+// before WiFi and NTP are back. The running clock is snapshotted to RTC slow
+// memory, which survives ESP.restart(), watchdog and panic resets but not a
+// power cycle. Last sync time and drift estimate also go to NVS on each sync.
+class TimeCache
+{
+public:
+    TimeCache();
+    void begin(); // Loads the NVS part
+    bool restore(); // Sets the system clock from RTC memory if it is not set yet
+    void save();    // Snapshot of the running clock, call about once a minute
+    void recordSync(int32_t driftPpb); // After a successful NTP sync
+
+    time_t getLastSyncEpoch() { return lastSyncEpoch; } // As stored in NVS, refreshed daily
+    int32_t getDriftPpb() { return driftPpb; }
+
+private:
+    Preferences preferences;
+    time_t lastSyncEpoch;
+    int32_t driftPpb; // Local clock rate error vs NTP, parts per billion (+ = runs fast)
+    int32_t storedDriftPpb; // Value in NVS
+
+    static void saveOnShutdown();
+    static TimeCache *instance; // For the shutdown handler
+};
+
+#endif
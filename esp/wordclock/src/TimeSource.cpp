@@ -0,0 +1,25 @@
+#include "TimeSource.h"
+#include <sys/time.h>
+
+time_t SystemTimeSource::now()
+{
+    return time(nullptr);
+}
+
+int64_t SystemTimeSource::nowUs()
+{
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+bool SystemTimeSource::getLocalTime(struct tm *info)
+{
+    return ::getLocalTime(info);
+}
+
+bool VirtualClock::getLocalTime(struct tm *info)
+{
+    time_t t = now();
+    return localtime_r(&t, info) != nullptr;
+}
@@ -0,0 +1,43 @@
+#ifndef TIME_SOURCE_H
+#define TIME_SOURCE_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// Where WordClock reads the wall clock from. The firmware uses the SNTP-synced
+// system clock; host runs inject a VirtualClock to fast-forward through time.
+class TimeSource
+{
+public:
+    virtual ~TimeSource() {}
+    virtual time_t now() = 0;
+    virtual int64_t nowUs() = 0; // Microseconds since the epoch
+    int64_t nowMs() { return nowUs() / 1000; }
+    virtual bool getLocalTime(struct tm *info) = 0; // Local time per the TZ environment variable
+};
+
+class SystemTimeSource : public TimeSource
+{
+public:
+    time_t now() override;
+    int64_t nowUs() override;
+    bool getLocalTime(struct tm *info) override;
+};
+
+// Clock that only moves when told to
+class VirtualClock : public TimeSource
+{
+public:
+    explicit VirtualClock(time_t start = 0) : epochUs((int64_t)start * 1000000) {}
+    void set(time_t t) { epochUs = (int64_t)t * 1000000; }
+    void advance(long seconds) { epochUs += (int64_t)seconds * 1000000; }
+    void advanceMs(long ms) { epochUs += (int64_t)ms * 1000; }
+    time_t now() override { return (time_t)(epochUs / 1000000); }
+    int64_t nowUs() override { return epochUs; }
+    bool getLocalTime(struct tm *info) override;
+
+private:
+    int64_t epochUs;
+};
+
+#endif
@@ -0,0 +1,208 @@
+#include "TimeSync.h"
+#include "SerialHelper.h"
+#include "esp_timer.h"
+
+TimeSync::TimeSync()
+    : started(false), probing(false), probeDone(false), probeOffsetUs(0), nextPollMs(0), sourceIndex(-1),
+      lock(portMUX_INITIALIZER_UNLOCKED), synced(false), refNtpUs(0), refMonoUs(0),
+      lastCorrectionMonoUs(0), lastOffsetMs(0), driftPpb(0), intervalMs(START_INTERVAL_MS), syncCount(0),
+      driftSamples(0)
+{
+}
+
+void TimeSync::begin(const char *tz, const String &servers, int32_t initialDriftPpb)
+{
+    if (!synced)
+    {
+        driftPpb = initialDriftPpb; // Estimate from the last boot until we measure our own
+    }
+    setenv("TZ", tz, 1);
+    tzset();
+
+    client.setServers(servers);
+    sourceIndex = -1;
+    started = true;
+    nextPollMs = millis();
+}
+
+bool TimeSync::update()
+{
+    if (!started)
+    {
+        return false;
+    }
+    if (!client.isPolling())
+    {
+        if ((long)(millis() - nextPollMs) >= 0 && !client.startPoll())
+        {
+            nextPollMs = millis() + RETRY_MS;
+        }
+        return false;
+    }
+    if (!client.update())
+    {
+        return false; // Still waiting for replies
+    }
+
+    int8_t best = client.getBestServer();
+    if (probing)
+    {
+        probing = false;
+        probeDone = best >= 0;
+        if (probeDone)
+        {
+            probeOffsetUs = client.getServer(best).offsetUs;
+        }
+        return false;
+    }
+    if (best < 0)
+    {
+        SERIAL_PRINT("NTP: no server answered, retrying in ");
+        SERIAL_PRINT(String(RETRY_MS / 1000).c_str());
+        SERIAL_PRINTLN(" s");
+        nextPollMs = millis() + RETRY_MS;
+        return false;
+    }
+
+    sourceIndex = best;
+    applySample(client.getServer(best));
+    nextPollMs = millis() + intervalMs;
+    return true;
+}
+
+bool TimeSync::startProbe()
+{
+    if (!started || client.isPolling() || !client.startPoll())
+    {
+        return false;
+    }
+    probing = true;
+    probeDone = false;
+    return true;
+}
+
+bool TimeSync::takeProbeOffset(int64_t *offsetUs)
+{
+    if (!probeDone)
+    {
+        return false;
+    }
+    probeDone = false;
+    *offsetUs = probeOffsetUs;
+    return true;
+}
+
+int64_t TimeSync::nowUs()
+{
+    int64_t monoUs = esp_timer_get_time();
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    int64_t wallUs = (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+
+    portENTER_CRITICAL(&lock);
+    int32_t ppb = synced ? driftPpb : 0;
+    int64_t sinceCorrectionUs = monoUs - lastCorrectionMonoUs;
+    portEXIT_CRITICAL(&lock);
+    wallUs -= sinceCorrectionUs * ppb / 1000000000;
+
+#ifndef WORDCLOCK_NATIVE
+    // Part of the last correction may still be being slewed in
+    struct timeval outstanding;
+    if (adjtime(nullptr, &outstanding) == 0)
+    {
+        wallUs += (int64_t)outstanding.tv_sec * 1000000 + outstanding.tv_usec;
+    }
+#endif
+    return wallUs;
+}
+
+void TimeSync::applySample(const NtpServer &server)
+{
+    // NTP time at the moment the reply arrived
+    int64_t ntpUs = server.replyWallUs + server.offsetUs;
+    int64_t monoUs = server.replyMonoUs;
+    lastOffsetMs = (int32_t)(server.offsetUs / 1000);
+
+    syncCount++;
+    if (synced)
+    {
+        // The oscillator counted elapsedUs while NTP says (ntpUs - refNtpUs) passed
+        int64_t elapsedUs = monoUs - refMonoUs;
+        if (elapsedUs >= MIN_DRIFT_SAMPLE_US)
+        {
+            int32_t measuredPpb = (int32_t)((elapsedUs - (ntpUs - refNtpUs)) * 1000000000 / elapsedUs);
+            int32_t newPpb = driftSamples == 0 ? measuredPpb : driftPpb + (measuredPpb - driftPpb) / 4;
+            portENTER_CRITICAL(&lock);
+            driftPpb = newPpb;
+            portEXIT_CRITICAL(&lock);
+            if (driftSamples < 0xFFFF)
+                driftSamples++;
+            adaptInterval();
+        }
+    }
+
+    portENTER_CRITICAL(&lock);
+    synced = true;
+    lastCorrectionMonoUs = monoUs;
+    portEXIT_CRITICAL(&lock);
+    refNtpUs = ntpUs;
+    refMonoUs = monoUs;
+
+#ifndef WORDCLOCK_NATIVE // The host clock is disciplined by the OS
+    // Step to the NtpClient sample; this also cancels any adjtime() still in progress
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    int64_t nowUs = (int64_t)now.tv_sec * 1000000 + now.tv_usec + server.offsetUs;
+    now.tv_sec = (time_t)(nowUs / 1000000);
+    now.tv_usec = (suseconds_t)(nowUs % 1000000);
+    settimeofday(&now, nullptr);
+#endif
+
+    SERIAL_PRINT("NTP sync from ");
+    SERIAL_PRINT(server.host.c_str());
+    SERIAL_PRINT(": offset ");
+    SERIAL_PRINT(String(lastOffsetMs).c_str());
+    SERIAL_PRINT(" ms, drift ");
+    SERIAL_PRINT(String(driftPpb / 1000.0, 2).c_str());
+    SERIAL_PRINT(" ppm, next in ");
+    SERIAL_PRINT(String(intervalMs / 60000).c_str());
+    SERIAL_PRINTLN(" min");
+}
+
+void TimeSync::adaptInterval()
+{
+    // Double while the clock stays well inside the target, halve when it misses
+    int32_t error = lastOffsetMs < 0 ? -lastOffsetMs : lastOffsetMs;
+    if (error * 2 < TARGET_ERROR_MS && intervalMs < MAX_INTERVAL_MS)
+    {
+        intervalMs = intervalMs * 2 > MAX_INTERVAL_MS ? MAX_INTERVAL_MS : intervalMs * 2;
+    }
+    else if (error > TARGET_ERROR_MS && intervalMs > MIN_INTERVAL_MS)
+    {
+        intervalMs = intervalMs / 2 < MIN_INTERVAL_MS ? MIN_INTERVAL_MS : intervalMs / 2;
+    }
+}
+
+void TimeSync::correctDrift()
+{
+    if (!synced || driftPpb == 0)
+    {
+        return;
+    }
+    int64_t monoUs = esp_timer_get_time();
+    int64_t gainedUs = (monoUs - lastCorrectionMonoUs) * driftPpb / 1000000000;
+    if (gainedUs == 0)
+    {
+        return; // Wait until there is at least a microsecond to take out
+    }
+    portENTER_CRITICAL(&lock);
+    lastCorrectionMonoUs = monoUs;
+    portEXIT_CRITICAL(&lock);
+
+#ifndef WORDCLOCK_NATIVE // The host clock is disciplined by the OS
+    struct timeval delta;
+    delta.tv_sec = (time_t)(-gainedUs / 1000000);
+    delta.tv_usec = (suseconds_t)(-gainedUs % 1000000);
+    adjtime(&delta, nullptr);
+#endif
+}
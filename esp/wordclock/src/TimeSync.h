@@ -0,0 +1,82 @@
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <Arduino.h>
+#include <sys/time.h>
+#include "NtpClient.h"
+#include "TimeSource.h"
+
+// Disciplines the system clock from a list of NTP servers without blocking.
+// Each poll asks all servers at once and steps the clock to the fastest
+// healthy one; update() also turns successive syncs into an oscillator drift
+// estimate, which correctDrift() slews out between syncs. The poll interval
+// adapts to the error seen at each sync.
+class TimeSync
+{
+public:
+    static const uint32_t MIN_INTERVAL_MS = 15UL * 60 * 1000;
+    static const uint32_t MAX_INTERVAL_MS = 24UL * 3600 * 1000;
+    static const uint32_t START_INTERVAL_MS = 3600UL * 1000;
+    static const uint32_t RETRY_MS = 15000; // After a poll nobody answered
+    static const int32_t TARGET_ERROR_MS = 50; // Worst clock error we accept between syncs
+    static const int64_t MIN_DRIFT_SAMPLE_US = 5LL * 60 * 1000000; // Shorter spans are mostly network jitter
+
+    TimeSync();
+    void begin(const char *tz, const String &servers, int32_t driftPpb); // Polls on the next update()
+    bool update();       // Call often while connected, true after a sync
+    void correctDrift(); // Call about once a minute
+    bool isPolling() { return client.isPolling(); } // Replies are timestamped when update() sees them
+
+    // Wall clock in microseconds with the drift correctDrift() has not taken
+    // out yet removed as well; safe to call from any task
+    int64_t nowUs();
+
+    // Measures the clock offset without correcting it (diagnostics). The result
+    // is picked up with takeProbeOffset() after update() finished the poll.
+    bool startProbe();
+    bool takeProbeOffset(int64_t *offsetUs); // NTP minus local clock
+
+    bool isSynced() { return synced; }
+    int32_t getLastOffsetMs() { return lastOffsetMs; } // NTP minus local clock at the last sync
+    int32_t getDriftPpb() { return driftPpb; }          // Parts per billion, + = local oscillator runs fast
+    uint32_t getIntervalMs() { return intervalMs; }
+    uint32_t getSyncCount() { return syncCount; }
+    int8_t getSourceIndex() { return sourceIndex; } // Server of the last sync, -1 before the first
+    NtpClient &getClient() { return client; }
+
+private:
+    NtpClient client;
+    bool started;
+    bool probing;
+    bool probeDone;
+    int64_t probeOffsetUs;
+    unsigned long nextPollMs;
+    int8_t sourceIndex;
+
+    portMUX_TYPE lock; // driftPpb and lastCorrectionMonoUs are read by nowUs() on other tasks
+    bool synced;
+    int64_t refNtpUs; // Last sync, as the reference for the drift estimate
+    int64_t refMonoUs;
+    int64_t lastCorrectionMonoUs;
+    int32_t lastOffsetMs;
+    int32_t driftPpb;
+    uint32_t intervalMs;
+    uint32_t syncCount;
+    uint16_t driftSamples; // Measured ones; until the first, driftPpb is the value from the last boot
+
+    void applySample(const NtpServer &server);
+    void adaptInterval();
+};
+
+// System clock as seen through a TimeSync, for WordClock
+class SyncedTimeSource : public SystemTimeSource
+{
+public:
+    explicit SyncedTimeSource(TimeSync *sync) : sync(sync) {}
+    int64_t nowUs() override { return sync->nowUs(); }
+
+private:
+    TimeSync *sync;
+};
+
+#endif
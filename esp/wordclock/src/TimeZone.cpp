@@ -0,0 +1,285 @@
+#include "TimeZone.h"
+#include <ctype.h>
+
+static const int64_t NEVER = INT64_MAX;
+static const int64_t SECONDS_PER_DAY = 86400;
+
+static bool isLeapYear(int year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static int daysInMonth(int year, int month)
+{
+    static const uint8_t DAYS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return month == 2 && isLeapYear(year) ? 29 : DAYS[month - 1];
+}
+
+// Zone name: three or more letters, or anything between < and >
+static bool parseName(const char *&p)
+{
+    if (*p == '<')
+    {
+        const char *close = strchr(p, '>');
+        if (!close)
+            return false;
+        p = close + 1;
+        return true;
+    }
+    const char *start = p;
+    while (isalpha((unsigned char)*p))
+        p++;
+    return p - start >= 3;
+}
+
+// [+|-]hh[:mm[:ss]] in seconds; hours up to 167 for rule times
+static bool parseTime(const char *&p, int32_t *seconds)
+{
+    int sign = 1;
+    if (*p == '+' || *p == '-')
+        sign = *p++ == '-' ? -1 : 1;
+    if (!isdigit((unsigned char)*p))
+        return false;
+    int32_t value = 0;
+    for (int field = 0; field < 3; field++)
+    {
+        int32_t part = 0;
+        if (!isdigit((unsigned char)*p))
+            return false;
+        while (isdigit((unsigned char)*p))
+            part = part * 10 + (*p++ - '0');
+        value += part * (field == 0 ? 3600 : field == 1 ? 60 : 1);
+        if (*p != ':')
+            break;
+        p++;
+    }
+    *seconds = sign * value;
+    return true;
+}
+
+static bool parseNumber(const char *&p, int *value)
+{
+    if (!isdigit((unsigned char)*p))
+        return false;
+    *value = 0;
+    while (isdigit((unsigned char)*p))
+        *value = *value * 10 + (*p++ - '0');
+    return true;
+}
+
+TimeZone::TimeZone()
+    : configured(false), parsed(false), hasDst(false), stdOffset(0), dstOffset(0), startRule(), endRule(),
+      windowStart(0), windowEnd(0), windowOffset(0), windowDst(false), dayStart(0), dayFields()
+{
+}
+
+bool TimeZone::set(const char *posix)
+{
+    configured = true;
+    parsed = posix && parse(posix);
+    windowStart = windowEnd = 0; // Empty: the first conversion computes it
+    dayStart = NEVER;
+    return parsed;
+}
+
+bool TimeZone::parse(const char *p)
+{
+    int32_t offset;
+    if (!parseName(p) || !parseTime(p, &offset))
+        return false;
+    stdOffset = -offset; // POSIX counts west of UTC
+    hasDst = *p != '\0';
+    if (!hasDst)
+        return true;
+
+    if (!parseName(p))
+        return false;
+    dstOffset = stdOffset + 3600;
+    if (*p != ',' && *p != '\0')
+    {
+        if (!parseTime(p, &offset))
+            return false;
+        dstOffset = -offset;
+    }
+    if (*p != ',')
+        return false; // Rules left to the implementation, let libc decide
+
+    Rule *rules[2] = {&startRule, &endRule};
+    for (Rule *rule : rules)
+    {
+        if (*p++ != ',')
+            return false;
+        int value;
+        *rule = Rule();
+        if (*p == 'M')
+        {
+            int month, week, day;
+            p++;
+            if (!parseNumber(p, &month) || *p++ != '.' || !parseNumber(p, &week) || *p++ != '.' ||
+                !parseNumber(p, &day) || month < 1 || month > 12 || week < 1 || week > 5 || day > 6)
+                return false;
+            rule->type = 'M';
+            rule->month = month;
+            rule->week = week;
+            rule->day = day;
+        }
+        else if (*p == 'J')
+        {
+            p++;
+            if (!parseNumber(p, &value) || value < 1 || value > 365)
+                return false;
+            rule->type = 'J';
+            rule->day = value;
+        }
+        else
+        {
+            if (!parseNumber(p, &value) || value > 365)
+                return false;
+            rule->type = 'D';
+            rule->day = value;
+        }
+        rule->timeSec = 2 * 3600;
+        if (*p == '/')
+        {
+            p++;
+            if (!parseTime(p, &rule->timeSec))
+                return false;
+        }
+    }
+    return *p == '\0';
+}
+
+// Days since 1970-01-01 (proleptic Gregorian)
+int64_t TimeZone::daysFromCivil(int year, int month, int day)
+{
+    int64_t y = month <= 2 ? year - 1 : year;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yearOfEra = y - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+void TimeZone::civilFromDays(int64_t days, int *year, int *month, int *day)
+{
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t mp = (5 * dayOfYear + 2) / 153;
+    *day = (int)(dayOfYear - (153 * mp + 2) / 5 + 1);
+    *month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *year = (int)(yearOfEra + era * 400 + (*month <= 2));
+}
+
+// The rule's moment in the given year as UTC; offsetBefore is the offset the
+// rule's local time of day is expressed in
+int64_t TimeZone::transitionUtc(const Rule &rule, int year, int32_t offsetBefore)
+{
+    int64_t day;
+    if (rule.type == 'M')
+    {
+        int64_t first = daysFromCivil(year, rule.month, 1);
+        int firstWeekday = (int)(((first % 7) + 11) % 7); // 1970-01-01 was a Thursday
+        int mday = 1 + (rule.day - firstWeekday + 7) % 7 + (rule.week - 1) * 7;
+        while (mday > daysInMonth(year, rule.month))
+            mday -= 7;
+        day = first + mday - 1;
+    }
+    else if (rule.type == 'J')
+    {
+        // Day 1..365, February 29 never counted
+        day = daysFromCivil(year, 1, 1) + rule.day - 1 + (isLeapYear(year) && rule.day >= 60 ? 1 : 0);
+    }
+    else
+    {
+        day = daysFromCivil(year, 1, 1) + rule.day;
+    }
+    return day * SECONDS_PER_DAY + rule.timeSec - offsetBefore;
+}
+
+void TimeZone::updateWindow(int64_t utc)
+{
+    if (!hasDst)
+    {
+        windowStart = INT64_MIN;
+        windowEnd = NEVER;
+        windowOffset = stdOffset;
+        windowDst = false;
+        return;
+    }
+
+    // Walk the transitions of the surrounding years in order to the first one
+    // after utc; the state before it is the opposite of the one it switches to
+    int64_t local = utc + stdOffset;
+    int year, month, day;
+    civilFromDays(local / SECONDS_PER_DAY - (local % SECONDS_PER_DAY < 0), &year, &month, &day);
+    int64_t previous = INT64_MIN;
+    bool previousDst = false;
+    for (int y = year - 1; y <= year + 1; y++)
+    {
+        int64_t start = transitionUtc(startRule, y, stdOffset);
+        int64_t end = transitionUtc(endRule, y, dstOffset);
+        int64_t first = start < end ? start : end;
+        int64_t second = start < end ? end : start;
+        bool firstIsStart = start < end;
+
+        int64_t transitions[2] = {first, second};
+        bool dstAfter[2] = {firstIsStart, !firstIsStart};
+        for (int i = 0; i < 2; i++)
+        {
+            if (transitions[i] > utc)
+            {
+                windowStart = previous;
+                windowEnd = transitions[i];
+                windowDst = !dstAfter[i];
+                windowOffset = windowDst ? dstOffset : stdOffset;
+                return;
+            }
+            previous = transitions[i];
+            previousDst = dstAfter[i];
+        }
+    }
+    windowStart = previous;
+    windowEnd = NEVER;
+    windowDst = previousDst;
+    windowOffset = previousDst ? dstOffset : stdOffset;
+}
+
+int32_t TimeZone::getOffset(time_t utc)
+{
+    if (utc < windowStart || utc >= windowEnd)
+        updateWindow(utc);
+    return windowOffset;
+}
+
+bool TimeZone::toLocal(time_t utc, struct tm *local)
+{
+    if (!parsed)
+        return localtime_r(&utc, local) != nullptr;
+
+    int64_t t = (int64_t)utc + getOffset(utc);
+    int64_t days = t / SECONDS_PER_DAY - (t % SECONDS_PER_DAY < 0);
+    int64_t secondOfDay = t - days * SECONDS_PER_DAY;
+
+    if (days * SECONDS_PER_DAY != dayStart)
+    {
+        int year, month, day;
+        civilFromDays(days, &year, &month, &day);
+        memset(&dayFields, 0, sizeof(dayFields));
+        dayFields.tm_year = year - 1900;
+        dayFields.tm_mon = month - 1;
+        dayFields.tm_mday = day;
+        dayFields.tm_wday = (int)(((days % 7) + 11) % 7);
+        dayFields.tm_yday = (int)(days - daysFromCivil(year, 1, 1));
+        dayStart = days * SECONDS_PER_DAY;
+    }
+
+    *local = dayFields;
+    local->tm_hour = (int)(secondOfDay / 3600);
+    local->tm_min = (int)(secondOfDay / 60 % 60);
+    local->tm_sec = (int)(secondOfDay % 60);
+    local->tm_isdst = windowDst ? 1 : 0;
+    return true;
+}
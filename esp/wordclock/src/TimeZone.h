@@ -0,0 +1,58 @@
+#ifndef TIME_ZONE_H
+#define TIME_ZONE_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// POSIX TZ rules (e.g. "CET-1CEST,M3.5.0,M10.5.0/3") evaluated once instead of
+// on every localtime() call. The UTC offset in force and the instants it took
+// effect and ends are cached, so converting a time inside that window is an
+// add plus the calendar split (itself cached per local day). Strings it cannot
+// parse fall back to localtime_r() with the TZ environment variable.
+class TimeZone
+{
+public:
+    TimeZone();
+
+    bool set(const char *posix); // False if unsupported: toLocal() then uses libc
+    bool isSet() { return configured; }
+    bool toLocal(time_t utc, struct tm *local);
+    int32_t getOffset(time_t utc); // Seconds east of UTC
+
+private:
+    // One transition rule: Jn, n or Mm.w.d plus the local time of day
+    struct Rule
+    {
+        char type; // 'J', 'D' (zero-based day) or 'M'
+        int16_t day;
+        int8_t month;
+        int8_t week;
+        int32_t timeSec;
+    };
+
+    bool configured;
+    bool parsed; // Rules below are valid, otherwise fall back to libc
+    bool hasDst;
+    int32_t stdOffset; // Seconds east of UTC
+    int32_t dstOffset;
+    Rule startRule; // Into DST, given in standard time
+    Rule endRule;   // Out of DST, given in DST
+
+    // Offset in force between windowStart (inclusive) and windowEnd
+    int64_t windowStart;
+    int64_t windowEnd;
+    int32_t windowOffset;
+    bool windowDst;
+
+    // Calendar fields of the local day last converted
+    int64_t dayStart;
+    struct tm dayFields;
+
+    bool parse(const char *posix);
+    void updateWindow(int64_t utc);
+    int64_t transitionUtc(const Rule &rule, int year, int32_t offsetBefore);
+    static int64_t daysFromCivil(int year, int month, int day);
+    static void civilFromDays(int64_t days, int *year, int *month, int *day);
+};
+
+#endif
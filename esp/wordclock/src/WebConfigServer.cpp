@@ -5,6 +5,56 @@
 
 #define DNS_PORT 53
 
+// Timezone strings with automatic DST support using POSIX TZ format
+// Format: STD offset DST [offset],start[/time],end[/time]
+const TimezoneOption WebConfigServer::TIMEZONES[] = {
+    // Americas
+    {"HST10", "UTC-10 Hawaii (no DST)"},
+    {"AKST9AKDT,M3.2.0,M11.1.0", "UTC-9/-8 Alaska"},
+    {"PST8PDT,M3.2.0,M11.1.0", "UTC-8/-7 Pacific Time (US)"},
+    {"MST7MDT,M3.2.0,M11.1.0", "UTC-7/-6 Mountain Time (US)"},
+    {"MST7", "UTC-7 Arizona (no DST)"},
+    {"CST6CDT,M3.2.0,M11.1.0", "UTC-6/-5 Central Time (US)"},
+    {"EST5EDT,M3.2.0,M11.1.0", "UTC-5/-4 Eastern Time (US)"},
+    {"AST4ADT,M3.2.0,M11.1.0", "UTC-4/-3 Atlantic Time (Canada)"},
+    {"NST3:30NDT,M3.2.0,M11.1.0", "UTC-3:30/-2:30 Newfoundland"},
+    {"<-03>3", "UTC-3 Buenos Aires, São Paulo (no DST)"},
+
+    // Europe & Africa
+    {"GMT0BST,M3.5.0/1,M10.5.0", "UTC+0/+1 London, Dublin"},
+    {"WET0WEST,M3.5.0/1,M10.5.0", "UTC+0/+1 Lisbon, Canary Islands"},
+    {"CET-1CEST,M3.5.0,M10.5.0/3", "UTC+1/+2 Amsterdam, Berlin, Paris"},
+    {"EET-2EEST,M3.5.0/3,M10.5.0/4", "UTC+2/+3 Athens, Helsinki, Kyiv"},
+    {"<+03>-3", "UTC+3 Moscow (no DST)"},
+    {"<+04>-4", "UTC+4 Dubai, Baku (no DST)"},
+
+    // Asia
+    {"<+0430>-4:30", "UTC+4:30 Kabul (no DST)"},
+    {"<+05>-5", "UTC+5 Pakistan (no DST)"},
+    {"IST-5:30", "UTC+5:30 India, Sri Lanka (no DST)"},
+    {"<+0545>-5:45", "UTC+5:45 Nepal (no DST)"},
+    {"<+06>-6", "UTC+6 Bangladesh, Dhaka (no DST)"},
+    {"<+0630>-6:30", "UTC+6:30 Myanmar, Yangon (no DST)"},
+    {"<+07>-7", "UTC+7 Bangkok, Jakarta, Hanoi (no DST)"},
+    {"CST-8", "UTC+8 China, Singapore, Perth (no DST)"},
+    {"JST-9", "UTC+9 Japan, Korea (no DST)"},
+
+    // Australia & Pacific
+    {"ACST-9:30ACDT,M10.1.0,M4.1.0/3", "UTC+9:30/+10:30 Adelaide"},
+    {"AEST-10AEDT,M10.1.0,M4.1.0/3", "UTC+10/+11 Sydney, Melbourne"},
+    {"AEST-10", "UTC+10 Brisbane (no DST)"},
+    {"<+11>-11", "UTC+11 Solomon Islands (no DST)"},
+    {"NZST-12NZDT,M9.5.0,M4.1.0/3", "UTC+12/+13 New Zealand"},
+    {"<+13>-13", "UTC+13 Tonga (no DST)"}
+};
+
+const char *WebConfigServer::DEFAULT_TIMEZONE = "CET-1CEST,M3.5.0,M10.5.0/3";
+
+int WebConfigServer::getTimezoneCount()
+{
+    return sizeof(TIMEZONES) / sizeof(TIMEZONES[0]);
+}
+
 WebConfigServer::WebConfigServer()
     : server(nullptr),
       dnsServer(nullptr),
@@ -16,10 +66,8 @@ WebConfigServer::WebConfigServer()
       startScanCallback(nullptr),
       getStatusCallback(nullptr),
       getTimezoneSettingsCallback(nullptr),
-      triggerGifCallback(nullptr),
-      triggerWordsTestCallback(nullptr),
-      triggerLedTestCallback(nullptr),
-      resumeNormalCallback(nullptr)
+      saveNtpServersCallback(nullptr),
+      displayCommands(nullptr)
 {
 }
 
@@ -158,7 +206,7 @@ String WebConfigServer::generateCommonCSS()
 String WebConfigServer::generateConfigFormCSS()
 {
     String css = "";
-    css += "input[type=password], select { width: 100%; padding: 10px; margin: 10px 0; border: 1px solid #ddd; border-radius: 5px; box-sizing: border-box; font-size: 14px; }";
+    css += "input[type=password], input[type=text], select { width: 100%; padding: 10px; margin: 10px 0; border: 1px solid #ddd; border-radius: 5px; box-sizing: border-box; font-size: 14px; }";
     css += ".checkbox-container { display: flex; align-items: center; margin: 15px 0; }";
     css += ".checkbox-container input[type=checkbox] { width: auto; margin-right: 10px; }";
     css += ".checkbox-container label { margin: 0; cursor: pointer; }";
@@ -232,49 +280,15 @@ String WebConfigServer::generateWifiScanJS()
 // Helper: Generate timezone dropdown options
 String WebConfigServer::generateTimezoneDropdown()
 {
-    // Timezone strings with automatic DST support using POSIX TZ format
-    // Format: STD offset DST [offset],start[/time],end[/time]
     String html = "";
-    
-    // Americas
-    html += "<option value='HST10'>UTC-10 Hawaii (no DST)</option>";
-    html += "<option value='AKST9AKDT,M3.2.0,M11.1.0'>UTC-9/-8 Alaska</option>";
-    html += "<option value='PST8PDT,M3.2.0,M11.1.0'>UTC-8/-7 Pacific Time (US)</option>";
-    html += "<option value='MST7MDT,M3.2.0,M11.1.0'>UTC-7/-6 Mountain Time (US)</option>";
-    html += "<option value='MST7'>UTC-7 Arizona (no DST)</option>";
-    html += "<option value='CST6CDT,M3.2.0,M11.1.0'>UTC-6/-5 Central Time (US)</option>";
-    html += "<option value='EST5EDT,M3.2.0,M11.1.0'>UTC-5/-4 Eastern Time (US)</option>";
-    html += "<option value='AST4ADT,M3.2.0,M11.1.0'>UTC-4/-3 Atlantic Time (Canada)</option>";
-    html += "<option value='NST3:30NDT,M3.2.0,M11.1.0'>UTC-3:30/-2:30 Newfoundland</option>";
-    html += "<option value='<-03>3'>UTC-3 Buenos Aires, São Paulo (no DST)</option>";
-    
-    // Europe & Africa
-    html += "<option value='GMT0BST,M3.5.0/1,M10.5.0'>UTC+0/+1 London, Dublin</option>";
-    html += "<option value='WET0WEST,M3.5.0/1,M10.5.0'>UTC+0/+1 Lisbon, Canary Islands</option>";
-    html += "<option value='CET-1CEST,M3.5.0,M10.5.0/3' selected>UTC+1/+2 Amsterdam, Berlin, Paris</option>";
-    html += "<option value='EET-2EEST,M3.5.0/3,M10.5.0/4'>UTC+2/+3 Athens, Helsinki, Kyiv</option>";
-    html += "<option value='<+03>-3'>UTC+3 Moscow (no DST)</option>";
-    html += "<option value='<+04>-4'>UTC+4 Dubai, Baku (no DST)</option>";
-    
-    // Asia
-    html += "<option value='<+0430>-4:30'>UTC+4:30 Kabul (no DST)</option>";
-    html += "<option value='<+05>-5'>UTC+5 Pakistan (no DST)</option>";
-    html += "<option value='IST-5:30'>UTC+5:30 India, Sri Lanka (no DST)</option>";
-    html += "<option value='<+0545>-5:45'>UTC+5:45 Nepal (no DST)</option>";
-    html += "<option value='<+06>-6'>UTC+6 Bangladesh, Dhaka (no DST)</option>";
-    html += "<option value='<+0630>-6:30'>UTC+6:30 Myanmar, Yangon (no DST)</option>";
-    html += "<option value='<+07>-7'>UTC+7 Bangkok, Jakarta, Hanoi (no DST)</option>";
-    html += "<option value='CST-8'>UTC+8 China, Singapore, Perth (no DST)</option>";
-    html += "<option value='JST-9'>UTC+9 Japan, Korea (no DST)</option>";
-    
-    // Australia & Pacific
-    html += "<option value='ACST-9:30ACDT,M10.1.0,M4.1.0/3'>UTC+9:30/+10:30 Adelaide</option>";
-    html += "<option value='AEST-10AEDT,M10.1.0,M4.1.0/3'>UTC+10/+11 Sydney, Melbourne</option>";
-    html += "<option value='AEST-10'>UTC+10 Brisbane (no DST)</option>";
-    html += "<option value='<+11>-11'>UTC+11 Solomon Islands (no DST)</option>";
-    html += "<option value='NZST-12NZDT,M9.5.0,M4.1.0/3'>UTC+12/+13 New Zealand</option>";
-    html += "<option value='<+13>-13'>UTC+13 Tonga (no DST)</option>";
-    
+    for (int i = 0; i < getTimezoneCount(); i++)
+    {
+        html += "<option value='";
+        html += TIMEZONES[i].tz;
+        html += strcmp(TIMEZONES[i].tz, DEFAULT_TIMEZONE) == 0 ? "' selected>" : "'>";
+        html += TIMEZONES[i].label;
+        html += "</option>";
+    }
     return html;
 }
 
@@ -358,24 +372,14 @@ void WebConfigServer::onGetTimezoneSettings(GetTimezoneSettingsCallback callback
     getTimezoneSettingsCallback = callback;
 }
 
-void WebConfigServer::onTriggerGif(TriggerGifCallback callback)
-{
-    triggerGifCallback = callback;
-}
-
-void WebConfigServer::onTriggerWordsTest(TriggerWordsTestCallback callback)
-{
-    triggerWordsTestCallback = callback;
-}
-
-void WebConfigServer::onTriggerLedTest(TriggerLedTestCallback callback)
+void WebConfigServer::onSaveNtpServers(SaveNtpServersCallback callback)
 {
-    triggerLedTestCallback = callback;
+    saveNtpServersCallback = callback;
 }
 
-void WebConfigServer::onResumeNormal(ResumeNormalCallback callback)
+void WebConfigServer::setDisplayCommandQueue(DisplayCommandQueue *queue)
 {
-    resumeNormalCallback = callback;
+    displayCommands = queue;
 }
 
 
@@ -596,6 +600,12 @@ void WebConfigServer::handleSaveTimezone(AsyncWebServerRequest *request)
         SERIAL_PRINT("Timezone string: ");
         SERIAL_PRINTLN(tzString.c_str());
         
+        // Optional, the page sends it along with the timezone
+        if (request->hasParam("ntpServers", true) && saveNtpServersCallback)
+        {
+            saveNtpServersCallback(request->getParam("ntpServers", true)->value());
+        }
+        
         // Save timezone only (pass special marker for WiFi to indicate no WiFi change)
         if (saveConfigCallback)
         {
@@ -621,65 +631,43 @@ void WebConfigServer::handleSaveTimezone(AsyncWebServerRequest *request)
     }
 }
 
-void WebConfigServer::handleTriggerGif(AsyncWebServerRequest *request)
+// Runs in the AsyncTCP task: only queue the command, the render task acts on it
+void WebConfigServer::postDisplayCommand(AsyncWebServerRequest *request, DisplayCommand command, const char *message)
 {
-    SERIAL_PRINTLN("handleTriggerGif called");
-    if (triggerGifCallback)
+    if (!displayCommands)
+    {
+        SERIAL_PRINTLN("ERROR: No display command queue set!");
+        request->send(500, "text/plain", "No display command queue");
+    }
+    else if (!displayCommands->post(command))
     {
-        SERIAL_PRINTLN("Calling triggerGifCallback...");
-        triggerGifCallback();
-        request->send(200, "text/plain", "GIF animation triggered");
+        SERIAL_PRINTLN("Display command queue full");
+        request->send(503, "text/plain", "Display busy, try again");
     }
     else
     {
-        SERIAL_PRINTLN("ERROR: No GIF callback set!");
-        request->send(500, "text/plain", "No GIF callback");
+        request->send(200, "text/plain", message);
     }
 }
 
+void WebConfigServer::handleTriggerGif(AsyncWebServerRequest *request)
+{
+    postDisplayCommand(request, CMD_TRIGGER_GIF, "GIF animation triggered");
+}
+
 void WebConfigServer::handleTriggerWords(AsyncWebServerRequest *request)
 {
-    SERIAL_PRINTLN("handleTriggerWords called");
-    if (triggerWordsTestCallback)
-    {
-        SERIAL_PRINTLN("Calling triggerWordsTestCallback...");
-        triggerWordsTestCallback();
-        request->send(200, "text/plain", "Words test started");
-    }
-    else
-    {
-        SERIAL_PRINTLN("ERROR: No words test callback set!");
-        request->send(500, "text/plain", "No words test callback");
-    }
+    postDisplayCommand(request, CMD_WORDS_TEST, "Words test started");
 }
 
 void WebConfigServer::handleTriggerLedTest(AsyncWebServerRequest *request)
 {
-    SERIAL_PRINTLN("handleTriggerLedTest called");
-    if (triggerLedTestCallback)
-    {
-        SERIAL_PRINTLN("Calling triggerLedTestCallback...");
-        triggerLedTestCallback();
-        request->send(200, "text/plain", "LED test started");
-    }
-    else
-    {
-        SERIAL_PRINTLN("ERROR: No LED test callback set!");
-        request->send(500, "text/plain", "No LED test callback");
-    }
+    postDisplayCommand(request, CMD_LED_TEST, "LED test started");
 }
 
 void WebConfigServer::handleResume(AsyncWebServerRequest *request)
 {
-    if (resumeNormalCallback)
-    {
-        resumeNormalCallback();
-        request->send(200, "text/plain", "Resumed normal operation");
-    }
-    else
-    {
-        request->send(500, "text/plain", "No resume callback");
-    }
+    postDisplayCommand(request, CMD_RESUME_NORMAL, "Resumed normal operation");
 }
 
 
@@ -883,6 +871,7 @@ String WebConfigServer::generateTimezoneSettingsHTML()
     html += "    .then(r => r.json())";
     html += "    .then(data => {";
     html += "      document.getElementById('timezone').value = data.tzString;";
+    html += "      document.getElementById('ntpServers').value = data.ntpServers || '';";
     html += "    })";
     html += "    .catch(e => console.error('Error loading settings:', e));";
     html += "};";
@@ -890,6 +879,7 @@ String WebConfigServer::generateTimezoneSettingsHTML()
     html += "  const timezone = document.getElementById('timezone').value;";  // Now contains TZ string
     html += "  const formData = new FormData();";
     html += "  formData.append('timezone', timezone);";
+    html += "  formData.append('ntpServers', document.getElementById('ntpServers').value);";
     html += "  document.getElementById('save-btn').disabled = true;";
     html += "  document.getElementById('save-btn').textContent = 'Saving...';";
     html += "  fetch('/save-timezone', { method: 'POST', body: formData })";
@@ -920,6 +910,8 @@ String WebConfigServer::generateTimezoneSettingsHTML()
     html += "<select id='timezone'>";
     html += generateTimezoneDropdown();
     html += "</select>";
+    html += "<label for='ntpServers'>NTP Servers (comma separated, empty for defaults):</label>";
+    html += "<input type='text' id='ntpServers' placeholder='192.168.1.1, pool.ntp.org'>";
     html += "<button id='save-btn' onclick='saveTimezone()'>Save Timezone</button>";
     html += "<button class='btn-secondary' onclick='window.location=\"/\"'>&#x2190; Back to Status</button>";
     html += "</div></body></html>";
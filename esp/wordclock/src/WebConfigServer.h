@@ -4,6 +4,7 @@
 #include <ESPAsyncWebServer.h>
 #include <DNSServer.h>
 #include <WiFi.h>
+#include "DisplayCommand.h"
 
 // Callback function types
 typedef void (*SaveConfigCallback)(String ssid, String password, String tzString); // Updated for TZ strings
@@ -11,10 +12,14 @@ typedef String (*GetNetworksCallback)();
 typedef void (*StartScanCallback)();
 typedef String (*GetStatusCallback)();
 typedef String (*GetTimezoneSettingsCallback)(); // Get current timezone settings
-typedef void (*TriggerGifCallback)();
-typedef void (*TriggerWordsTestCallback)();
-typedef void (*TriggerLedTestCallback)();
-typedef void (*ResumeNormalCallback)();
+typedef void (*SaveNtpServersCallback)(String servers); // Comma separated, preferred first
+
+// Entry of the timezone dropdown
+struct TimezoneOption
+{
+    const char *tz;    // POSIX TZ string, stored as-is in preferences
+    const char *label;
+};
 
 enum ServerMode {
     MODE_SETUP,    // AP mode - initial configuration
@@ -39,14 +44,16 @@ public:
     void onStartScan(StartScanCallback callback);
     void onGetStatus(GetStatusCallback callback);
     void onGetTimezoneSettings(GetTimezoneSettingsCallback callback); // New
-    void onTriggerGif(TriggerGifCallback callback);
-    void onTriggerWordsTest(TriggerWordsTestCallback callback);
-    void onTriggerLedTest(TriggerLedTestCallback callback);
-    void onResumeNormal(ResumeNormalCallback callback);
+    void onSaveNtpServers(SaveNtpServersCallback callback);
+    void setDisplayCommandQueue(DisplayCommandQueue *queue); // Target of the /trigger/* routes
     
     // Notify that save was successful (triggers reboot)
     void notifySaveSuccess();
 
+    static const TimezoneOption TIMEZONES[];
+    static const char *DEFAULT_TIMEZONE;
+    static int getTimezoneCount();
+
 private:
     AsyncWebServer *server;
     DNSServer *dnsServer;
@@ -60,10 +67,8 @@ private:
     StartScanCallback startScanCallback;
     GetStatusCallback getStatusCallback;
     GetTimezoneSettingsCallback getTimezoneSettingsCallback; // New
-    TriggerGifCallback triggerGifCallback;
-    TriggerWordsTestCallback triggerWordsTestCallback;
-    TriggerLedTestCallback triggerLedTestCallback;
-    ResumeNormalCallback resumeNormalCallback;
+    SaveNtpServersCallback saveNtpServersCallback;
+    DisplayCommandQueue *displayCommands;
     
     void setupRoutes();
     void handleRoot(AsyncWebServerRequest *request);
@@ -79,6 +84,7 @@ private:
     void handleTriggerWords(AsyncWebServerRequest *request);
     void handleTriggerLedTest(AsyncWebServerRequest *request);
     void handleResume(AsyncWebServerRequest *request);
+    void postDisplayCommand(AsyncWebServerRequest *request, DisplayCommand command, const char *message);
     
     String generateSetupHTML();
     String generateStatusHTML();
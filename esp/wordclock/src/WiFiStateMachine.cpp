@@ -0,0 +1,127 @@
+#include "WiFiStateMachine.h"
+
+WiFiStateMachine::WiFiStateMachine()
+    : state(WIFI_STATE_IDLE), haveCredentials(false), attempting(false), failures(0), attemptStartMs(0), waitStartMs(0), retryDelayMs(0) {}
+
+WiFiAction WiFiStateMachine::start(bool credentials, unsigned long nowMs)
+{
+    haveCredentials = credentials;
+    failures = 0;
+    if (!haveCredentials)
+    {
+        state = WIFI_STATE_AP_FALLBACK;
+        attempting = false;
+        waitStartMs = nowMs;
+        retryDelayMs = AP_RETRY_MIN_MS;
+        return WIFI_ACTION_START_AP;
+    }
+    state = WIFI_STATE_CONNECTING;
+    return beginAttempt(nowMs);
+}
+
+WiFiAction WiFiStateMachine::handleEvent(WiFiLinkEvent event, unsigned long nowMs)
+{
+    if (event == WIFI_LINK_GOT_IP)
+    {
+        if (state == WIFI_STATE_CONNECTED || !attempting)
+            return WIFI_ACTION_NONE; // Late event from an abandoned attempt
+        state = WIFI_STATE_CONNECTED;
+        attempting = false;
+        failures = 0;
+        return WIFI_ACTION_CONNECTED;
+    }
+
+    // Disconnects while waiting are echoes of our own disconnect() calls
+    if (state == WIFI_STATE_CONNECTED)
+    {
+        state = WIFI_STATE_BACKOFF;
+        failures = 0;
+        waitStartMs = nowMs;
+        retryDelayMs = backoffDelay();
+        return WIFI_ACTION_LOST;
+    }
+    if (attempting)
+    {
+        return attemptFailed(nowMs);
+    }
+    return WIFI_ACTION_NONE;
+}
+
+WiFiAction WiFiStateMachine::update(unsigned long nowMs)
+{
+    if (attempting)
+    {
+        if (nowMs - attemptStartMs >= ATTEMPT_TIMEOUT_MS)
+            return attemptFailed(nowMs);
+        return WIFI_ACTION_NONE;
+    }
+
+    if (haveCredentials && (state == WIFI_STATE_BACKOFF || state == WIFI_STATE_AP_FALLBACK) &&
+        nowMs - waitStartMs >= retryDelayMs)
+    {
+        if (state == WIFI_STATE_BACKOFF)
+            state = WIFI_STATE_CONNECTING;
+        return beginAttempt(nowMs);
+    }
+    return WIFI_ACTION_NONE;
+}
+
+const char *WiFiStateMachine::stateName(WiFiState state)
+{
+    switch (state)
+    {
+    case WIFI_STATE_IDLE:
+        return "idle";
+    case WIFI_STATE_CONNECTING:
+        return "connecting";
+    case WIFI_STATE_CONNECTED:
+        return "connected";
+    case WIFI_STATE_BACKOFF:
+        return "backoff";
+    case WIFI_STATE_AP_FALLBACK:
+        return "ap-fallback";
+    }
+    return "?";
+}
+
+WiFiAction WiFiStateMachine::beginAttempt(unsigned long nowMs)
+{
+    attempting = true;
+    attemptStartMs = nowMs;
+    return WIFI_ACTION_BEGIN;
+}
+
+WiFiAction WiFiStateMachine::attemptFailed(unsigned long nowMs)
+{
+    attempting = false;
+    if (failures < 255)
+        failures++;
+    waitStartMs = nowMs;
+    retryDelayMs = backoffDelay();
+
+    if (state == WIFI_STATE_AP_FALLBACK)
+    {
+        if (retryDelayMs < AP_RETRY_MIN_MS)
+            retryDelayMs = AP_RETRY_MIN_MS;
+        return WIFI_ACTION_FAILED; // AP already up
+    }
+    if (failures >= AP_FALLBACK_FAILURES)
+    {
+        state = WIFI_STATE_AP_FALLBACK;
+        if (retryDelayMs < AP_RETRY_MIN_MS)
+            retryDelayMs = AP_RETRY_MIN_MS;
+        return WIFI_ACTION_START_AP;
+    }
+    state = WIFI_STATE_BACKOFF;
+    return WIFI_ACTION_FAILED;
+}
+
+unsigned long WiFiStateMachine::backoffDelay()
+{
+    // Exponential in the failure count, with "equal jitter": half fixed, half
+    // random, so clocks that lost the same access point do not retry in step
+    unsigned long delayMs = BACKOFF_MAX_MS;
+    if (failures < 16 && (BACKOFF_BASE_MS << failures) < BACKOFF_MAX_MS)
+        delayMs = BACKOFF_BASE_MS << failures;
+    return delayMs / 2 + random(delayMs / 2 + 1);
+}
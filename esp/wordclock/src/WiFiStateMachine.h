@@ -0,0 +1,69 @@
+#ifndef WIFI_STATE_MACHINE_H
+#define WIFI_STATE_MACHINE_H
+
+#include <Arduino.h>
+
+// Station connection policy, kept free of WiFi calls so it can be driven by
+// recorded events on the host. NetworkManager feeds it WiFi.onEvent results
+// and the clock, and carries out the action each call returns.
+enum WiFiState : uint8_t
+{
+    WIFI_STATE_IDLE,        // No credentials
+    WIFI_STATE_CONNECTING,  // WiFi.begin() issued, waiting for an IP
+    WIFI_STATE_CONNECTED,
+    WIFI_STATE_BACKOFF,     // Waiting before the next attempt
+    WIFI_STATE_AP_FALLBACK  // Setup AP running, station attempts continue in the background if there are credentials
+};
+
+enum WiFiLinkEvent : uint8_t
+{
+    WIFI_LINK_GOT_IP,
+    WIFI_LINK_DISCONNECTED // Attempt failed or connection lost
+};
+
+enum WiFiAction : uint8_t
+{
+    WIFI_ACTION_NONE,
+    WIFI_ACTION_BEGIN,     // Start a connection attempt
+    WIFI_ACTION_FAILED,    // Attempt failed, backing off
+    WIFI_ACTION_CONNECTED, // Got an IP (stop the AP if it runs)
+    WIFI_ACTION_LOST,      // Connection dropped, backing off
+    WIFI_ACTION_START_AP   // Too many failures, start the setup AP
+};
+
+class WiFiStateMachine
+{
+public:
+    static const unsigned long ATTEMPT_TIMEOUT_MS = 20000;
+    static const unsigned long BACKOFF_BASE_MS = 1000;
+    static const unsigned long BACKOFF_MAX_MS = 300000;
+    static const unsigned long AP_RETRY_MIN_MS = 60000; // Station attempts disturb the setup AP
+    static const uint8_t AP_FALLBACK_FAILURES = 3;
+
+    WiFiStateMachine();
+
+    WiFiAction start(bool haveCredentials, unsigned long nowMs);
+    WiFiAction handleEvent(WiFiLinkEvent event, unsigned long nowMs);
+    WiFiAction update(unsigned long nowMs); // Timeouts and backoff expiry
+
+    WiFiState getState() { return state; }
+    bool isAttempting() { return attempting; }
+    uint8_t getFailures() { return failures; } // Consecutive failed attempts
+    unsigned long getRetryDelay() { return retryDelayMs; } // Last backoff chosen
+    static const char *stateName(WiFiState state);
+
+private:
+    WiFiState state;
+    bool haveCredentials; // Without them the AP waits for setup, no station attempts
+    bool attempting;
+    uint8_t failures;
+    unsigned long attemptStartMs;
+    unsigned long waitStartMs;
+    unsigned long retryDelayMs;
+
+    WiFiAction beginAttempt(unsigned long nowMs);
+    WiFiAction attemptFailed(unsigned long nowMs);
+    unsigned long backoffDelay();
+};
+
+#endif
@@ -1,79 +1,63 @@
 #include "WordClock.h"
 #include "SerialHelper.h"
-#include "esp_task_wdt.h"
+#include "AnimationStore.h"
+#include <LittleFS.h>
 
-WordClock::WordClock(ClockDisplayHAL *clockDisplayHAL, NetworkManager *networkManager, GifPlayer *gifPlayer)
-    : clockDisplayHAL(clockDisplayHAL), networkManager(networkManager), gifPlayer(gifPlayer), lastHour(-1), allLastHighlightedWords(""), gifDownloaded(false) {}
+const char *WordClock::GIF_URL = "https://raw.githubusercontent.com/johniak/word-clock/refs/heads/main/raspberry-pi/heart_art_small.gif";
 
-void WordClock::setup()
-{
-    downloadGIF();
-}
+static SystemTimeSource systemTime;
+
+static const int64_t SLOT_US = 5 * 60 * 1000000LL; // One sentence per five minutes
+static const time_t MIN_VALID_EPOCH = 1483228800; // 2017-01-01, anything earlier means not synced yet
+
+WordClock::WordClock(ClockDisplayHAL *clockDisplayHAL, GifPlayer *gifPlayer)
+    : lastHour(-1), lastFrameIndex(-1), clockDisplayHAL(clockDisplayHAL), gifPlayer(gifPlayer), timeSource(&systemTime), gifLoaded(false), wordsTestIndex(0),
+      flipCount(0), flipLatencyTotalUs(0), flipLatencyMaxUs(0), lastFlipErrorUs(0) {}
 
 void WordClock::forceRefresh()
 {
     // Clear the cached state to force an immediate display update
-    allLastHighlightedWords = "";
+    lastFrameIndex = -1;
     lastHour = -1;
     SERIAL_PRINTLN("WordClock state cleared, next displayTime() will refresh immediately");
 }
 
-void WordClock::downloadGIF()
+void WordClock::setTimeSource(TimeSource *source)
+{
+    timeSource = source ? source : &systemTime;
+    forceRefresh();
+}
+
+void WordClock::setTimeZone(const char *posix)
 {
-    if (!gifDownloaded)
+    if (!timeZone.set(posix))
     {
-        const char *gifUrl = "https://raw.githubusercontent.com/johniak/word-clock/refs/heads/main/raspberry-pi/heart_art_small.gif";
-        if (networkManager->downloadGIF(gifUrl))
-        {
-            uint8_t *gifBuffer = networkManager->getGifBuffer();
-            size_t gifSize = networkManager->getGifBufferSize();
-            if (gifSize > 0 && gifBuffer != nullptr)
-            {
-                if (gifPlayer->loadGIF(gifBuffer, gifSize))
-                {
-                    gifDownloaded = true;
-                    SERIAL_PRINTLN("GIF downloaded and loaded successfully.");
-                }
-            }
-        }
-        else
-        {
-            SERIAL_PRINTLN("Failed to download GIF.");
-        }
+        SERIAL_PRINT("TZ rules not understood, using localtime(): ");
+        SERIAL_PRINTLN(posix ? posix : "(none)");
     }
+    lastFrameIndex = -1; // Same sentence may now mean a different time
+    lastHour = -1;
 }
 
-void WordClock::highlightWord(const String &word, uint32_t color)
+bool WordClock::loadGIF()
 {
-    clockDisplayHAL->displayWord(word, color);
+    if (gifPlayer->loadGIF(LittleFS, AnimationStore::PATH))
+    {
+        gifLoaded = true;
+        SERIAL_PRINTLN("GIF loaded from flash.");
+    }
+    return gifLoaded;
 }
 
-String WordClock::getMinutesWord(int minute)
-{
-    if (minute < 5)
-        return "OCLOCK";
-    else if (minute < 10)
-        return "FIVE";
-    else if (minute < 15)
-        return "TEN";
-    else if (minute < 20)
-        return "FIFTEEN";
-    else if (minute < 25)
-        return "TWENTY";
-    else if (minute < 30)
-        return "TWENTYFIVE";
-    else if (minute < 35)
-        return "THIRTY";
-    else if (minute < 40)
-        return "TWENTYFIVE";
-    else if (minute < 45)
-        return "TWENTY";
-    else if (minute < 50)
-        return "FIFTEEN";
-    else if (minute < 55)
-        return "TEN";
-    else
-        return "FIVE";
+void WordClock::setAnimation(GifAnimation *animation)
+{
+    gifPlayer->setAnimation(animation);
+    gifLoaded = animation != nullptr;
+}
+
+void WordClock::highlightWord(WordId word, uint32_t color)
+{
+    clockDisplayHAL->displayWord(word, color);
 }
 
 uint32_t WordClock::getRandomColor()
@@ -85,121 +69,147 @@ uint32_t WordClock::getRandomColor()
 
 void WordClock::displayTime()
 {
-    struct tm currentTime = networkManager->getLocalTimeStruct();
+    struct tm currentTime;
+    int64_t usIntoSlot;
+    if (!readTime(&currentTime, &usIntoSlot))
+    {
+        memset(&currentTime, 0, sizeof(struct tm));
+        usIntoSlot = -1;
+        SERIAL_PRINTLN("Failed to obtain local time");
+    }
     int hour = currentTime.tm_hour % 12;
     if (hour == 0)
         hour = 12;
     int minute = currentTime.tm_min;
 
-    clockDisplayHAL->clearPixels(false);
-
     if (hour != lastHour && minute == 0)
     {
         lastHour = hour;
-        if (gifDownloaded)
+        if (gifLoaded && gifPlayer->start(GIF_PLAY_MS))
         {
-            gifPlayer->playGIF(4000);
+            lastFrameIndex = -1; // Redraw once the animation is over
         }
-        clockDisplayHAL->clearPixels(false);
+    }
+    if (gifPlayer->isPlaying())
+    {
+        return; // The animation owns the display until it ends
     }
 
-    highlightWord("IT", getRandomColor());
-    highlightWord("IS", getRandomColor());
-    String allHighlightedWords = "ITIS";
-
-    if (minute < 5)
+    const uint8_t frameIndex = clockFrameIndex(currentTime.tm_hour, minute);
+    if (frameIndex == lastFrameIndex)
     {
-        highlightWord("OCLOCK", getRandomColor());
-        allHighlightedWords += "OCLOCK";
+        return; // Nothing visible changed, keep the current frame and colors
     }
-    else if (minute < 35)
+
+    const ClockFrame &frame = CLOCK_FRAMES[frameIndex];
+    clockDisplayHAL->clearPixels(false);
+    for (uint8_t i = 0; i < frame.wordCount; i++)
     {
-        highlightWord("PAST", getRandomColor());
-        highlightWord("MINUTES", getRandomColor());
-        allHighlightedWords += "PASTMINUTES";
+        highlightWord(frame.words[i], getRandomColor());
     }
-    else
+    clockDisplayHAL->present();
+
+    // Only flips caused by the clock advancing count, not forced redraws. The
+    // error is taken once the frame is out, on the same clock that chose it.
+    if (lastFrameIndex >= 0 && usIntoSlot >= 0)
     {
-        highlightWord("TO", getRandomColor());
-        highlightWord("MINUTES", getRandomColor());
-        allHighlightedWords += "TOMINUTES";
-        hour = (hour + 1) % 12;
-        if (hour == 0)
-            hour = 12;
+        struct tm shownAt;
+        int64_t usAfterBoundary;
+        if (!readTime(&shownAt, &usAfterBoundary))
+            usAfterBoundary = usIntoSlot;
+        lastFlipErrorUs = (int32_t)(usAfterBoundary < usIntoSlot ? usIntoSlot : usAfterBoundary);
+        flipCount++;
+        flipLatencyTotalUs += lastFlipErrorUs;
+        if (lastFlipErrorUs > flipLatencyMaxUs)
+            flipLatencyMaxUs = lastFlipErrorUs;
     }
+    lastFrameIndex = frameIndex;
+}
+
+bool WordClock::readTime(struct tm *local, int64_t *usIntoSlot)
+{
+    // One clock read for both the sentence and the sub-second position
+    int64_t nowUs = timeSource->nowUs();
+    time_t seconds = (time_t)(nowUs / 1000000);
+    if (!timeZone.isSet())
+        timeZone.set(getenv("TZ"));
+    if (seconds < MIN_VALID_EPOCH || !timeZone.toLocal(seconds, local))
+        return false;
+
+    *usIntoSlot = ((local->tm_min % 5) * 60 + local->tm_sec) * 1000000LL + nowUs % 1000000;
+    return true;
+}
+
+int64_t WordClock::usUntilNextFrame()
+{
+    struct tm local;
+    int64_t usIntoSlot;
+    if (!readTime(&local, &usIntoSlot))
+        return 1000000; // Not synced yet, check again soon
+    return SLOT_US - usIntoSlot;
+}
 
-    String hourWord = "HOUR_" + String(hour);
-    highlightWord(getMinutesWord(minute), getRandomColor());
-    allHighlightedWords += getMinutesWord(minute);
-    highlightWord(hourWord, getRandomColor());
-    allHighlightedWords += hourWord;
+unsigned long WordClock::msUntilNextFrame()
+{
+    return (unsigned long)((usUntilNextFrame() + 999) / 1000);
+}
+
+bool WordClock::hasValidTime()
+{
+    struct tm local;
+    int64_t usIntoSlot;
+    return readTime(&local, &usIntoSlot);
+}
 
-    if (allLastHighlightedWords != allHighlightedWords)
+void WordClock::printFlipStats()
+{
+    SERIAL_PRINT("Frame flips: ");
+    SERIAL_PRINT(String(flipCount).c_str());
+    if (flipCount > 0)
     {
-        clockDisplayHAL->show();
-        allLastHighlightedWords = allHighlightedWords;
+        SERIAL_PRINT(", latency after boundary avg ");
+        SERIAL_PRINT(String(flipLatencyTotalUs / flipCount / 1000.0, 2).c_str());
+        SERIAL_PRINT(" ms, max ");
+        SERIAL_PRINT(String(flipLatencyMaxUs / 1000.0, 2).c_str());
+        SERIAL_PRINT(" ms");
     }
+    SERIAL_PRINTLN("");
 }
 
-void WordClock::triggerGif()
+bool WordClock::triggerGif()
 {
-    if (gifDownloaded)
+    if (gifLoaded && gifPlayer->start(GIF_PLAY_MS))
     {
         SERIAL_PRINTLN("Playing GIF animation...");
-        gifPlayer->playGIF(4000);
-        clockDisplayHAL->clearPixels(false);
-    }
-    else
-    {
-        SERIAL_PRINTLN("GIF not downloaded yet");
+        lastFrameIndex = -1;
+        return true;
     }
+    SERIAL_PRINTLN("GIF not downloaded yet");
+    return false;
 }
 
-void WordClock::runWordsTest(bool (*shouldAbort)())
+void WordClock::beginWordsTest()
 {
     SERIAL_PRINTLN("Starting words test - cycling through all words...");
-    
-    clockDisplayHAL->clearPixels(false);
-    
+    wordsTestIndex = 0;
+}
+
+bool WordClock::stepWordsTest()
+{
     // Use the word list directly from ClockDisplayHAL (DRY principle)
-    int numWords = ClockDisplayHAL::getWordCount();
-    
-    // Display each word for 1 second with a random color
-    for (int i = 0; i < numWords; i++)
+    if (wordsTestIndex >= ClockDisplayHAL::getWordCount())
     {
-        // Check if test should abort
-        if (shouldAbort && shouldAbort())
-        {
-            SERIAL_PRINTLN("Words test aborted by user");
-            clockDisplayHAL->clearPixels(true);
-            return;
-        }
-        
-        esp_task_wdt_reset(); // Feed watchdog during test
-        
-        String wordName = String(ClockDisplayHAL::WORDS_TO_LEDS[i].word);
-        
-        clockDisplayHAL->clearPixels(false);
-        highlightWord(wordName, getRandomColor());
-        clockDisplayHAL->show();
-        
-        SERIAL_PRINT("Displaying: ");
-        SERIAL_PRINTLN(wordName.c_str());
-        
-        // Delay with abort checks every 100ms
-        for (int d = 0; d < 10; d++)
-        {
-            if (shouldAbort && shouldAbort())
-            {
-                SERIAL_PRINTLN("Words test aborted by user");
-                clockDisplayHAL->clearPixels(true);
-                return;
-            }
-            delay(100);
-        }
+        clockDisplayHAL->clearPixels(true);
+        SERIAL_PRINTLN("Words test complete");
+        return false;
     }
-    
-    clockDisplayHAL->clearPixels(true);
-    SERIAL_PRINTLN("Words test complete");
-    esp_task_wdt_reset();
+
+    clockDisplayHAL->clearPixels(false);
+    highlightWord((WordId)wordsTestIndex, getRandomColor());
+    clockDisplayHAL->present();
+
+    SERIAL_PRINT("Displaying: ");
+    SERIAL_PRINTLN(ClockDisplayHAL::WORDS_TO_LEDS[wordsTestIndex].word);
+    wordsTestIndex++;
+    return true;
 }
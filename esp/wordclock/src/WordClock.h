@@ -3,32 +3,58 @@
 
 #include <Arduino.h>
 #include "ClockDisplayHAL.h"
-#include "NetworkManager.h"
+#include "ClockFrames.h"
 #include "GifPlayer.h"
+#include "TimeSource.h"
+#include "TimeZone.h"
 
 class WordClock
 {
 public:
-    WordClock(ClockDisplayHAL *clockDisplayHAL, NetworkManager *networkManager, GifPlayer *gifPlayer);
-    void setup();
+    WordClock(ClockDisplayHAL *clockDisplayHAL, GifPlayer *gifPlayer);
+    static const char *GIF_URL;
+
+    bool loadGIF(); // From the AnimationStore, after a download elsewhere
+    void setAnimation(GifAnimation *animation); // Decoded on another task, see GifPlayer::decode()
     void displayTime();
+    int64_t usUntilNextFrame(); // Time until the sentence changes (next five-minute boundary)
+    unsigned long msUntilNextFrame(); // Same, rounded up so a wake-up never lands before it
+    bool hasValidTime(); // Clock set, by NTP or restored after a warm reboot
+    void printFlipStats();
+    uint32_t getFlipCount() { return flipCount; }
+    int32_t getLastFlipErrorUs() { return lastFlipErrorUs; } // Frame shown this long after its boundary
     void forceRefresh(); // Force immediate display update
+    void setTimeSource(TimeSource *source); // Defaults to the system clock
+    void setTimeZone(const char *posix); // Defaults to the TZ environment variable at the first read
     
-    // Test/trigger functions
-    void triggerGif();
-    void runWordsTest(bool (*shouldAbort)() = nullptr); // Optional abort check callback
+    // Hourly animation, played by ticking the GifPlayer until it stops
+    static const unsigned long GIF_PLAY_MS = 4000;
+    bool triggerGif(); // False if there is no GIF to play
+
+    // Words test: each word in a random color, one word per step
+    static const unsigned long WORDS_TEST_STEP_MS = 1000;
+    void beginWordsTest();
+    bool stepWordsTest(); // Returns false (and clears) once every word was shown
 
 private:
     int lastHour;
-    String allLastHighlightedWords;
+    int lastFrameIndex; // Index into CLOCK_FRAMES of the frame on display, -1 if none
     ClockDisplayHAL *clockDisplayHAL;
-    NetworkManager *networkManager;
     GifPlayer *gifPlayer;
-    bool gifDownloaded;
+    TimeSource *timeSource;
+    TimeZone timeZone; // Only used from the render task
+    bool gifLoaded;
+    uint8_t wordsTestIndex;
+
+    // How late frame flips landed after their five-minute boundary
+    uint32_t flipCount;
+    uint64_t flipLatencyTotalUs;
+    int32_t flipLatencyMaxUs;
+    int32_t lastFlipErrorUs;
+
+    bool readTime(struct tm *local, int64_t *usIntoSlot);
 
-    void downloadGIF();
-    void highlightWord(const String &word, uint32_t color = 0xFFFFFF);
-    String getMinutesWord(int minute);
+    void highlightWord(WordId word, uint32_t color = 0xFFFFFF);
     uint32_t getRandomColor();
 };
 
@@ -0,0 +1,209 @@
+#ifndef WORD_LAYOUT_H
+#define WORD_LAYOUT_H
+
+#include <stdint.h>
+
+// Compile-time description of the clock face. Kept free of Arduino includes so
+// host tools (see bench/) can use the exact same tables as the firmware.
+
+// Physical grid; the strip snakes from the bottom-right corner upwards
+static constexpr uint8_t LAYOUT_WIDTH = 12;
+static constexpr uint8_t LAYOUT_HEIGHT = 11;
+
+struct StripIndexTable
+{
+    uint8_t index[LAYOUT_HEIGHT][LAYOUT_WIDTH];
+};
+
+constexpr StripIndexTable buildStripIndexTable()
+{
+    const uint8_t numLeds = LAYOUT_WIDTH * LAYOUT_HEIGHT;
+    StripIndexTable table{};
+    for (uint8_t y = 0; y < LAYOUT_HEIGHT; y++)
+    {
+        for (uint8_t x = 0; x < LAYOUT_WIDTH; x++)
+        {
+            if (y % 2 == 0)
+                table.index[y][x] = numLeds - y * LAYOUT_WIDTH - (x + 1); // Right to left
+            else
+                table.index[y][x] = numLeds - (y + 1) * LAYOUT_WIDTH + x; // Left to right
+        }
+    }
+    return table;
+}
+
+// Cartesian (x, y) -> LED strip index, (0, 0) is the top-left corner
+inline constexpr StripIndexTable STRIP_INDEX = buildStripIndexTable();
+
+static_assert(STRIP_INDEX.index[0][0] == 131 && STRIP_INDEX.index[10][11] == 0, "Serpentine layout changed");
+
+// One bit per LED on the strip (12 x 11 = 132 LEDs -> 5 x 32-bit words)
+struct LedMask
+{
+    static constexpr uint16_t NUM_BITS = 132;
+    static constexpr uint8_t NUM_WORDS = (NUM_BITS + 31) / 32;
+
+    uint32_t bits[NUM_WORDS];
+
+    constexpr LedMask() : bits{} {}
+
+    constexpr LedMask &set(uint16_t index)
+    {
+        bits[index >> 5] |= (uint32_t)1 << (index & 31);
+        return *this;
+    }
+
+    constexpr bool test(uint16_t index) const
+    {
+        return (bits[index >> 5] >> (index & 31)) & 1;
+    }
+
+    constexpr LedMask &operator|=(const LedMask &other)
+    {
+        for (uint8_t i = 0; i < NUM_WORDS; i++)
+        {
+            bits[i] |= other.bits[i];
+        }
+        return *this;
+    }
+
+    constexpr LedMask operator|(const LedMask &other) const
+    {
+        LedMask result = *this;
+        result |= other;
+        return result;
+    }
+
+    constexpr bool operator==(const LedMask &other) const
+    {
+        for (uint8_t i = 0; i < NUM_WORDS; i++)
+        {
+            if (bits[i] != other.bits[i])
+                return false;
+        }
+        return true;
+    }
+
+    constexpr bool operator!=(const LedMask &other) const
+    {
+        return !(*this == other);
+    }
+
+    constexpr bool isEmpty() const
+    {
+        for (uint8_t i = 0; i < NUM_WORDS; i++)
+        {
+            if (bits[i])
+                return false;
+        }
+        return true;
+    }
+
+    // Inclusive LED range [start, end]
+    static constexpr LedMask span(uint8_t start, uint8_t end)
+    {
+        LedMask mask;
+        for (uint16_t i = start; i <= end; i++)
+        {
+            mask.set(i);
+        }
+        return mask;
+    }
+};
+
+// Order must match WORD_SPANS below
+enum WordId : uint8_t
+{
+    WORD_HOUR_1,
+    WORD_HOUR_2,
+    WORD_HOUR_3,
+    WORD_HOUR_4,
+    WORD_HOUR_5,
+    WORD_HOUR_6,
+    WORD_HOUR_7,
+    WORD_HOUR_8,
+    WORD_HOUR_9,
+    WORD_HOUR_10,
+    WORD_HOUR_11,
+    WORD_HOUR_12,
+    WORD_OCLOCK,
+    WORD_PAST,
+    WORD_TO,
+    WORD_MINUTES,
+    WORD_THIRTY,
+    WORD_TWENTY,
+    WORD_TWENTYFIVE,
+    WORD_FIVE,
+    WORD_TEN,
+    WORD_FIFTEEN,
+    WORD_IS,
+    WORD_IT,
+    WORD_COUNT
+};
+
+struct WordSpan
+{
+    const char *word;
+    uint8_t start;
+    uint8_t end;
+};
+
+inline constexpr WordSpan WORD_SPANS[WORD_COUNT] = {
+    {"HOUR_1", 20, 22},
+    {"HOUR_2", 45, 47},
+    {"HOUR_3", 15, 19},
+    {"HOUR_4", 67, 70},
+    {"HOUR_5", 40, 43},
+    {"HOUR_6", 12, 14},
+    {"HOUR_7", 55, 59},
+    {"HOUR_8", 31, 35},
+    {"HOUR_9", 36, 39},
+    {"HOUR_10", 9, 11},
+    {"HOUR_11", 24, 29},
+    {"HOUR_12", 48, 53},
+    {"OCLOCK", 0, 5},
+    {"PAST", 60, 63},
+    {"TO", 63, 64},
+    {"MINUTES", 77, 83},
+    {"THIRTY", 84, 89},
+    {"TWENTY", 102, 107},
+    {"TWENTYFIVE", 98, 107},
+    {"FIVE", 98, 101},
+    {"TEN", 91, 93},
+    {"FIFTEEN", 110, 116},
+    {"IS", 127, 128},
+    {"IT", 130, 131}};
+
+struct WordMaskTable
+{
+    LedMask masks[WORD_COUNT];
+
+    constexpr const LedMask &operator[](uint8_t id) const
+    {
+        return masks[id];
+    }
+};
+
+constexpr WordMaskTable buildWordMasks()
+{
+    WordMaskTable table;
+    for (uint8_t i = 0; i < WORD_COUNT; i++)
+    {
+        table.masks[i] = LedMask::span(WORD_SPANS[i].start, WORD_SPANS[i].end);
+    }
+    return table;
+}
+
+// Precomputed LED mask per word, evaluated by the compiler
+inline constexpr WordMaskTable WORD_MASKS = buildWordMasks();
+
+// Maps an hour (1-12) to its word
+constexpr WordId hourWord(int hour)
+{
+    return (WordId)(WORD_HOUR_1 + (hour - 1));
+}
+
+static_assert(WORD_MASKS[WORD_IT].test(130) && WORD_MASKS[WORD_IT].test(131), "WORD_MASKS out of sync with WORD_SPANS");
+static_assert(hourWord(12) == WORD_HOUR_12, "Hour words must be contiguous");
+
+#endif
@@ -4,15 +4,89 @@
 #include "SerialHelper.h"
 #include "config.h"
 #include "GifPlayer.h"
+#include <LittleFS.h>
 #include "WordClock.h"
+#include "Scheduler.h"
+#include "SpscQueue.h"
+#include "DisplayCommand.h"
+#include "TimeCache.h"
+#include "BootTrace.h"
 #include "esp_task_wdt.h"
+#include "esp_timer.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "driver/gpio.h"
 
 NetworkManager networkManager(DEFAULT_GMT_OFFSET_SEC, DEFAULT_DAYLIGHT_OFFSET_SEC);
 ClockDisplayHAL clockDisplayHAL(LED_PIN, 255);
 GifPlayer gifPlayer(&clockDisplayHAL);
-WordClock wordClock(&clockDisplayHAL, &networkManager, &gifPlayer);
+WordClock wordClock(&clockDisplayHAL, &gifPlayer);
+TimeCache timeCache;
 
-// Test mode state
+// Display work runs on the application core, WiFi/NTP/HTTP on the protocol
+// core next to the WiFi driver. The only link between them is networkEvents.
+#define RENDER_CORE 1
+#define NETWORK_CORE 0
+#define RENDER_TASK_STACK 6144
+#define NETWORK_TASK_STACK 12288 // HTTPS download of the GIF
+#define RENDER_TASK_PRIORITY 2
+#define NETWORK_TASK_PRIORITY 1
+
+Scheduler renderScheduler;  // Only used by the render task
+Scheduler networkScheduler; // Only used by the network task
+TaskHandle_t renderTaskHandle = nullptr;
+
+// Producers notify the render task after queueing, so it can sleep until the
+// next deadline instead of polling its inboxes
+void wakeRenderTask()
+{
+  if (renderTaskHandle)
+  {
+    xTaskNotifyGive(renderTaskHandle);
+  }
+}
+
+SpscQueue<NetworkEvent, 8> networkEvents;            // Network task -> render task
+DisplayCommandQueue displayCommands(wakeRenderTask); // Web handlers -> render task
+
+#ifndef LIGHT_SLEEP_ENABLE
+#define LIGHT_SLEEP_ENABLE 0 // Automatic light sleep while both cores idle (needs CONFIG_PM_ENABLE)
+#endif
+
+#ifndef FLIP_ERROR_LOG
+#define FLIP_ERROR_LOG 0 // Log every frame flip's error relative to NTP time
+#endif
+
+#ifndef GIF_SCALE_MODE
+#define GIF_SCALE_MODE 1 // GifPlayer::SCALE_LETTERBOX
+#endif
+
+// Task periods (ms)
+#define BUTTON_TASK_MS 20      // Reset button hold detection, only while pressed
+#define RENDER_TASK_MS 1000    // Clock face retry while offline; online it sleeps to the next flip
+#define FLIP_BACKUP_MS 1000    // Scheduler fallback behind the flip timer
+#define ANIMATION_TASK_MS 50   // AP mode color cycle
+#define TEST_TASK_MS 500       // Pause between test pattern loops
+#define GIF_PLAYBACK_TASK_MS 20 // Only while an animation plays; rescheduled to each frame's delay
+#define NETWORK_TASK_MS 50     // WiFi, scans, DNS and web server housekeeping
+#define NTP_REPLY_POLL_MS 1    // Network task period while NTP replies are outstanding
+#define NTP_TASK_MS 60000      // Drift correction, RTC time snapshot
+#define GIF_TASK_MS 60000      // Whether the GIF on flash is due for revalidation
+#define STATS_TASK_MS 3600000  // Scheduler timing report
+
+int buttonTaskId = -1;
+int renderTaskId = -1;
+int animationTaskId = -1;
+int testTaskId = -1;
+int networkTaskId = -1;
+int gifPlaybackTaskId = -1;
+bool gifOnFlash = false; // Decoded by the network task on its first gifTask()
+
+// Network state as last reported to the render task
+NetworkEventType networkState = NET_EVENT_DISCONNECTED;
+bool timeSynced = false; // NTP answered at least once
+
+// Test mode state, only touched by the render task
 enum TestMode {
   TEST_MODE_NONE,
   TEST_MODE_GIF,
@@ -20,13 +94,8 @@ enum TestMode {
   TEST_MODE_LED
 };
 
-volatile TestMode currentTestMode = TEST_MODE_NONE;
-
-// Helper function to check if test should abort
-bool shouldAbortTest()
-{
-  return (currentTestMode == TEST_MODE_NONE);
-}
+TestMode currentTestMode = TEST_MODE_NONE;
+TestMode runningTest = TEST_MODE_NONE; // Pattern the test task is in the middle of
 
 void displayAPMode()
 {
@@ -35,15 +104,15 @@ void displayAPMode()
   clockDisplayHAL.clearPixels(false);
   
   // Slowly cycle through colors on "IT" and "IS" to indicate AP mode
-  uint32_t color = clockDisplayHAL.pixels.ColorHSV(hue * 256, 255, 128);
-  clockDisplayHAL.displayWord("IT", color);
-  clockDisplayHAL.displayWord("IS", color);
-  clockDisplayHAL.show();
+  uint32_t color = ClockDisplayHAL::ColorHSV(hue * 256, 255, 128);
+  clockDisplayHAL.displayWord(WORD_IT, color);
+  clockDisplayHAL.displayWord(WORD_IS, color);
+  clockDisplayHAL.present();
   
   hue = (hue + 1) % 256;
 }
 
-void checkResetButtonWithVisuals()
+bool checkResetButtonWithVisuals()
 {
   // Check if reset button was triggered (held for 3+ seconds)
   if (networkManager.checkResetButton())
@@ -52,218 +121,578 @@ void checkResetButtonWithVisuals()
     clockDisplayHAL.clearPixels(false);
     for (int i = 0; i < 3; i++)
     {
-      clockDisplayHAL.pixels.fill(0xFF0000); // Red
-      clockDisplayHAL.show();
+      clockDisplayHAL.fill(0xFF0000); // Red
+      clockDisplayHAL.present();
       delay(200);
       clockDisplayHAL.clearPixels(true);
       delay(200);
     }
     
-    // Reboot
-    SERIAL_PRINTLN("Rebooting...");
-    delay(1000);
-    ESP.restart();
+    // The settings belong to the network task, which clears them and reboots
+    networkManager.requestReset();
+    return true;
   }
+  return false;
 }
 
-// Wrapper functions for callbacks - just set test mode flags
-void triggerGif()
+void startGifPlayback()
 {
-  SERIAL_PRINTLN("Entering GIF test mode");
-  currentTestMode = TEST_MODE_GIF;
+  renderScheduler.setEnabled(gifPlaybackTaskId, true);
+  renderScheduler.runSoon(gifPlaybackTaskId);
 }
 
-void triggerWordsTest()
+void stopGifPlayback()
 {
-  SERIAL_PRINTLN("Entering words test mode");
-  currentTestMode = TEST_MODE_WORDS;
+  gifPlayer.stop();
+  renderScheduler.setEnabled(gifPlaybackTaskId, false);
 }
 
-void triggerLedTest()
+void enterTestMode(TestMode mode)
 {
-  SERIAL_PRINTLN("Entering LED test mode");
-  currentTestMode = TEST_MODE_LED;
+  stopGifPlayback();
+  currentTestMode = mode;
+  runningTest = TEST_MODE_NONE; // (Re)start the pattern on the next test tick
+  renderScheduler.setEnabled(testTaskId, true);
+  renderScheduler.runSoon(testTaskId);
 }
 
 void resumeNormal()
 {
-  SERIAL_PRINTLN("=== Resume Normal Function Called ===");
-  SERIAL_PRINT("Current test mode before: ");
-  SERIAL_PRINTLN(String(currentTestMode).c_str());
+  SERIAL_PRINTLN("=== Resume Normal ===");
   currentTestMode = TEST_MODE_NONE;
-  SERIAL_PRINT("Current test mode after: ");
-  SERIAL_PRINTLN(String(currentTestMode).c_str());
-  SERIAL_PRINTLN("Clearing display...");
+  stopGifPlayback();
   clockDisplayHAL.clearPixels(true);
-  SERIAL_PRINTLN("Forcing clock refresh...");
   wordClock.forceRefresh(); // Clear cached state to force immediate update
-  SERIAL_PRINTLN("=== Resume Complete ===");
+  renderScheduler.runSoon(renderTaskId);
 }
 
-void setup()
+// Web UI commands; runs on the render task only
+void handleDisplayCommands()
 {
-  initSerial();
-  
-  // Initialize display first for startup progress indicators
-  clockDisplayHAL.setup();
-  clockDisplayHAL.clearPixels(true);
-  
-  // Progress LED 1: Serial initialized
-  SERIAL_PRINTLN("=== STARTUP: Step 1 - Serial OK ===");
-  clockDisplayHAL.setPixel(0, 0, 0x0000FF); // Blue
-  clockDisplayHAL.show();
-  delay(200);
-  
-  // Setup reset button with internal pull-up
-  pinMode(RESET_BUTTON_PIN, INPUT_PULLUP);
-  networkManager.setResetButtonPin(RESET_BUTTON_PIN);
-  
-  // Progress LED 2: Setting up callbacks
-  SERIAL_PRINTLN("=== STARTUP: Step 2 - Setting callbacks ===");
-  clockDisplayHAL.setPixel(1, 0, 0x0000FF); // Blue
-  clockDisplayHAL.show();
-  networkManager.setTriggerGifCallback(triggerGif);
-  networkManager.setTriggerWordsTestCallback(triggerWordsTest);
-  networkManager.setTriggerLedTestCallback(triggerLedTest);
-  networkManager.setResumeNormalCallback(resumeNormal);
-  delay(200);
-  
-  // Progress LED 3: Starting network manager
-  SERIAL_PRINTLN("=== STARTUP: Step 3 - Starting network ===");
-  clockDisplayHAL.setPixel(2, 0, 0x00FF00); // Green
-  clockDisplayHAL.show();
-  
-  // NetworkManager setup will check button during connection attempts
-  networkManager.setup();
-  
-  // Progress LED 4: Network ready
-  SERIAL_PRINTLN("=== STARTUP: Step 4 - Network ready ===");
-  clockDisplayHAL.setPixel(3, 0, 0x00FF00); // Green
-  clockDisplayHAL.show();
-  delay(200);
-  
-  // Progress LED 5: WordClock setup (if connected)
-  if (networkManager.isConnected())
+  DisplayCommand command;
+  while (displayCommands.pop(command))
   {
-    SERIAL_PRINTLN("=== STARTUP: Step 5 - Setting up WordClock ===");
-    clockDisplayHAL.setPixel(4, 0, 0x00FF00); // Green
-    clockDisplayHAL.show();
-    wordClock.setup();
-    delay(200);
+    switch (command)
+    {
+      case CMD_TRIGGER_GIF:
+        SERIAL_PRINTLN("Entering GIF test mode");
+        enterTestMode(TEST_MODE_GIF);
+        break;
+
+      case CMD_WORDS_TEST:
+        SERIAL_PRINTLN("Entering words test mode");
+        enterTestMode(TEST_MODE_WORDS);
+        break;
+
+      case CMD_LED_TEST:
+        SERIAL_PRINTLN("Entering LED test mode");
+        enterTestMode(TEST_MODE_LED);
+        break;
+
+      case CMD_RESUME_NORMAL:
+        resumeNormal();
+        break;
+    }
   }
-  
-  // All done - flash all progress LEDs green
-  SERIAL_PRINTLN("=== STARTUP: COMPLETE ===");
-  for (int i = 0; i < 5; i++)
+}
+
+// ---- Render task (RENDER_CORE) ----
+
+volatile bool buttonWake = false;
+volatile bool flipDue = false;
+esp_timer_handle_t flipTimer = nullptr;
+
+// esp_timer task: the five-minute boundary has come, to the microsecond
+void onFlipTimer(void *)
+{
+  flipDue = true;
+  wakeRenderTask();
+}
+
+// The scheduler and FreeRTOS only count whole milliseconds/ticks, so the flip
+// itself is armed on a one-shot esp_timer
+void armFlipTimer(int64_t delayUs)
+{
+  if (!flipTimer)
   {
-    clockDisplayHAL.setPixel(i, 0, 0x00FF00); // Green
+    esp_timer_create_args_t args = {};
+    args.callback = onFlipTimer;
+    args.name = "flip";
+    esp_timer_create(&args, &flipTimer);
   }
-  clockDisplayHAL.show();
-  delay(500);
-  
-  // Clear display for normal operation
-  clockDisplayHAL.clearPixels(true);
+  esp_timer_stop(flipTimer); // Fails harmlessly when not running
+  esp_timer_start_once(flipTimer, delayUs > 0 ? delayUs : 1);
 }
 
-void loop()
+void IRAM_ATTR onResetButtonPressed()
 {
-  // Feed the watchdog to prevent resets
-  esp_task_wdt_reset();
-  
-  // Check reset button (with visual feedback)
-  checkResetButtonWithVisuals();
-  
-  // Update network manager (handles reconnection, AP mode, etc.)
-  networkManager.update();
-  
-  // Handle test modes (run continuously until resume button clicked)
-  if (currentTestMode != TEST_MODE_NONE)
+  BaseType_t higherPriorityTaskWoken = pdFALSE;
+  buttonWake = true;
+  if (renderTaskHandle)
   {
-    static TestMode lastReportedTestMode = TEST_MODE_NONE;
-    if (lastReportedTestMode != currentTestMode)
-    {
-      SERIAL_PRINT("TEST MODE ACTIVE: ");
-      SERIAL_PRINTLN(String(currentTestMode).c_str());
-      lastReportedTestMode = currentTestMode;
-    }
-    
-    switch (currentTestMode)
+    vTaskNotifyGiveFromISR(renderTaskHandle, &higherPriorityTaskWoken);
+  }
+  if (higherPriorityTaskWoken)
+  {
+    portYIELD_FROM_ISR();
+  }
+}
+
+void buttonTask()
+{
+  // Poll only while held; the next press wakes us through the interrupt
+  if (checkResetButtonWithVisuals() || digitalRead(RESET_BUTTON_PIN) == HIGH)
+  {
+    renderScheduler.setEnabled(buttonTaskId, false);
+  }
+}
+
+void handleNetworkEvents()
+{
+  NetworkEvent event;
+  while (networkEvents.pop(event))
+  {
+    switch (event.type)
     {
-      case TEST_MODE_GIF:
-        wordClock.triggerGif();
-        delay(500); // Pause between loops
+      case NET_EVENT_GIF_READY:
+        // Decoded on the network task; taking it over is a pointer swap
+        wordClock.setAnimation(event.animation);
+        BootTrace::mark("gif loaded");
         break;
-        
-      case TEST_MODE_WORDS:
-        wordClock.runWordsTest(shouldAbortTest);
-        delay(500); // Pause between loops
+
+      case NET_EVENT_TIME_SYNCED:
+        // The clock may have jumped, so the sleep to the next flip is stale
+        timeSynced = true;
+        renderScheduler.runSoon(renderTaskId);
+        break;
+
+      case NET_EVENT_AP_MODE:
+        SERIAL_PRINTLN("=== ENTERED AP MODE ===");
+        networkState = event.type;
+        stopGifPlayback();
+        renderScheduler.setEnabled(animationTaskId, true);
         break;
-        
-      case TEST_MODE_LED:
-        clockDisplayHAL.runLedTest(shouldAbortTest);
-        delay(500); // Pause between loops
+
+      case NET_EVENT_CONNECTED:
+        SERIAL_PRINTLN("=== ENTERED NORMAL MODE (Connected) ===");
+        networkState = event.type;
+        renderScheduler.setEnabled(animationTaskId, false);
+        wordClock.forceRefresh();
+        renderScheduler.runSoon(renderTaskId);
         break;
-        
+
       default:
-        currentTestMode = TEST_MODE_NONE;
+        SERIAL_PRINTLN("=== WAITING TO CONNECT ===");
+        networkState = event.type;
+        renderScheduler.setEnabled(animationTaskId, false);
         break;
     }
-    
-    // If resume was clicked during the test, currentTestMode is now NONE
-    // Don't return, let it fall through to normal operation
-    if (currentTestMode != TEST_MODE_NONE)
-    {
-      return; // Skip normal display, loop again for next test iteration
-    }
-    else
+  }
+}
+
+void testTask()
+{
+  // Test patterns advance one step per tick and repeat until resume is clicked
+  static TestMode lastReportedTestMode = TEST_MODE_NONE;
+  if (currentTestMode == TEST_MODE_NONE)
+  {
+    if (lastReportedTestMode != TEST_MODE_NONE)
     {
       SERIAL_PRINTLN("Test mode ended, resuming normal operation");
       lastReportedTestMode = TEST_MODE_NONE;
-      // Don't return - fall through to normal operation
+      runningTest = TEST_MODE_NONE;
+      renderScheduler.setPeriod(testTaskId, TEST_TASK_MS);
     }
+    renderScheduler.setEnabled(testTaskId, false);
+    return;
   }
-  
-  // Normal operation mode (reduce log spam)
-  static bool lastWasAPMode = false;
-  static bool lastWasConnected = false;
-  
-  // Only display time if we're connected to WiFi
-  // In AP mode, show a visual indicator instead
-  if (networkManager.isInAPMode())
+
+  if (lastReportedTestMode != currentTestMode)
+  {
+    SERIAL_PRINT("TEST MODE ACTIVE: ");
+    SERIAL_PRINTLN(String(currentTestMode).c_str());
+    lastReportedTestMode = currentTestMode;
+  }
+
+  if (runningTest != currentTestMode)
   {
-    if (!lastWasAPMode)
+    runningTest = currentTestMode;
+    if (runningTest == TEST_MODE_WORDS)
     {
-      SERIAL_PRINTLN("=== ENTERED AP MODE ===");
-      lastWasAPMode = true;
-      lastWasConnected = false;
+      wordClock.beginWordsTest();
+      renderScheduler.setPeriod(testTaskId, WordClock::WORDS_TEST_STEP_MS);
+    }
+    else if (runningTest == TEST_MODE_LED)
+    {
+      clockDisplayHAL.beginLedTest();
+      renderScheduler.setPeriod(testTaskId, ClockDisplayHAL::LED_TEST_STEP_MS);
     }
-    displayAPMode();
-    delay(50); // Faster update for animation
   }
-  else if (networkManager.isConnected())
+
+  bool more = false;
+  switch (currentTestMode)
   {
-    if (!lastWasConnected)
+    case TEST_MODE_GIF:
+      // The playback task runs the animation and wakes us again once it is over
+      if (wordClock.triggerGif())
+      {
+        startGifPlayback();
+        renderScheduler.setEnabled(testTaskId, false);
+        return;
+      }
+      break;
+
+    case TEST_MODE_WORDS:
+      more = wordClock.stepWordsTest();
+      break;
+
+    case TEST_MODE_LED:
+      more = clockDisplayHAL.stepLedTest();
+      break;
+
+    default:
+      currentTestMode = TEST_MODE_NONE;
+      break;
+  }
+
+  // Pattern complete: pause, then start it over
+  if (!more)
+  {
+    runningTest = TEST_MODE_NONE;
+    renderScheduler.setPeriod(testTaskId, TEST_TASK_MS);
+  }
+}
+
+void renderClock()
+{
+  // Test patterns own the display while active; AP mode has its own animation
+  if (currentTestMode != TEST_MODE_NONE || networkState == NET_EVENT_AP_MODE)
+  {
+    return;
+  }
+
+  // Nothing to show before the first NTP answer, unless RTC memory had the time
+  if (!wordClock.hasValidTime())
+  {
+    return;
+  }
+
+#if FLIP_ERROR_LOG
+  uint32_t flips = wordClock.getFlipCount();
+#endif
+  wordClock.displayTime();
+  if (gifPlayer.isPlaying())
+  {
+    startGifPlayback(); // Hourly animation; the playback task brings the clock face back
+    return;
+  }
+#if FLIP_ERROR_LOG
+  if (wordClock.getFlipCount() != flips)
+  {
+    SERIAL_PRINT("Flip ");
+    SERIAL_PRINT(String(wordClock.getLastFlipErrorUs() / 1000.0, 2).c_str());
+    SERIAL_PRINTLN(" ms after the boundary on the local clock");
+    networkManager.measureFlip(wordClock.getLastFlipErrorUs());
+  }
+#endif
+  BootTrace::mark("first frame");
+  if (timeSynced)
+  {
+    static bool traced = false;
+    if (!traced)
     {
-      SERIAL_PRINTLN("=== ENTERED NORMAL MODE (Connected) ===");
-      lastWasConnected = true;
-      lastWasAPMode = false;
+      BootTrace::mark("first synced frame");
+      BootTrace::print();
+      traced = true;
     }
-    // Try to download GIF if we haven't yet
-    wordClock.setup();
-    
-    // Display the actual time
-    wordClock.displayTime();
-    delay(1000);
+  }
+
+  // Nothing visible changes before the next five-minute boundary, sleep until
+  // then. A wake-up that lands early finds the old frame and re-arms for the rest.
+  armFlipTimer(wordClock.usUntilNextFrame());
+  renderScheduler.runAfter(renderTaskId, wordClock.msUntilNextFrame() + FLIP_BACKUP_MS);
+}
+
+void gifPlaybackTask()
+{
+  unsigned long nextMs = gifPlayer.tick();
+  if (gifPlayer.isPlaying())
+  {
+    renderScheduler.runAfter(gifPlaybackTaskId, nextMs);
+    return;
+  }
+
+  // Over: the GIF test pauses and starts over, otherwise the clock face returns
+  renderScheduler.setEnabled(gifPlaybackTaskId, false);
+  if (currentTestMode == TEST_MODE_GIF)
+  {
+    clockDisplayHAL.clearPixels(true);
+    renderScheduler.setEnabled(testTaskId, true);
+    renderScheduler.runAfter(testTaskId, TEST_TASK_MS);
   }
   else
   {
-    if (lastWasAPMode || lastWasConnected)
+    renderScheduler.runSoon(renderTaskId);
+  }
+}
+
+void animationTask()
+{
+  if (currentTestMode == TEST_MODE_NONE && networkState == NET_EVENT_AP_MODE)
+  {
+    displayAPMode();
+  }
+}
+
+void renderStatsTask()
+{
+  SERIAL_PRINTLN("Render core:");
+  renderScheduler.printStats();
+  wordClock.printFlipStats();
+}
+
+void renderTaskMain(void *parameter)
+{
+  buttonTaskId = renderScheduler.addTask("button", buttonTask, BUTTON_TASK_MS);
+  renderTaskId = renderScheduler.addTask("render", renderClock, RENDER_TASK_MS, 100);
+  animationTaskId = renderScheduler.addTask("animation", animationTask, ANIMATION_TASK_MS);
+  testTaskId = renderScheduler.addTask("test", testTask, TEST_TASK_MS);
+  gifPlaybackTaskId = renderScheduler.addTask("gif", gifPlaybackTask, GIF_PLAYBACK_TASK_MS);
+  renderScheduler.addTask("stats", renderStatsTask, STATS_TASK_MS);
+
+  // Enabled on demand: button press, AP mode, test command, animation
+  renderScheduler.setEnabled(buttonTaskId, false);
+  renderScheduler.setEnabled(animationTaskId, false);
+  renderScheduler.setEnabled(testTaskId, false);
+  renderScheduler.setEnabled(gifPlaybackTaskId, false);
+
+  for (;;)
+  {
+    // Inboxes first: a notification means one of them has work for us
+    handleNetworkEvents();
+    handleDisplayCommands();
+    if (buttonWake)
+    {
+      buttonWake = false;
+      renderScheduler.setEnabled(buttonTaskId, true);
+    }
+    if (flipDue)
     {
-      SERIAL_PRINTLN("=== WAITING TO CONNECT ===");
-      lastWasAPMode = false;
-      lastWasConnected = false;
+      flipDue = false;
+      renderScheduler.runSoon(renderTaskId);
     }
-    // Waiting to connect - just delay
-    delay(500);
+
+    // Run whatever is due, then sleep until the next deadline or notification
+    unsigned long idleMs = renderScheduler.run();
+    if (idleMs > 0)
+    {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(idleMs));
+    }
+  }
+}
+
+// ---- Network task (NETWORK_CORE) ----
+
+void postNetworkState()
+{
+  static NetworkEventType lastPosted = NET_EVENT_DISCONNECTED;
+  static bool posted = false;
+
+  NetworkEventType state = NET_EVENT_DISCONNECTED;
+  if (networkManager.isInAPMode())
+    state = NET_EVENT_AP_MODE;
+  else if (networkManager.isConnected())
+    state = NET_EVENT_CONNECTED;
+
+  // A full queue is retried on the next tick
+  if ((!posted || state != lastPosted) && networkEvents.push({state, nullptr}))
+  {
+    lastPosted = state;
+    posted = true;
+    wakeRenderTask();
+  }
+}
+
+void networkTask()
+{
+  static bool syncToPost = false;
+  networkManager.update();
+
+  // A full queue is retried on the next tick
+  syncToPost |= networkManager.takeTimeSynced();
+  if (syncToPost && networkEvents.push({NET_EVENT_TIME_SYNCED, nullptr}))
+  {
+    syncToPost = false;
+    wakeRenderTask();
+  }
+  postNetworkState();
+
+  // NTP replies are timestamped when update() reads them, so poll closely
+  // while a request is out to keep the round trip measurement honest
+  networkScheduler.setPeriod(networkTaskId, networkManager.isTimeSyncPolling() ? NTP_REPLY_POLL_MS : NETWORK_TASK_MS);
+}
+
+void ntpTask()
+{
+  networkManager.updateTimeSync();
+  timeCache.save(); // Bounds what a crash or watchdog reset loses to a minute
+}
+
+void gifTask()
+{
+  // The copy on flash is used from boot; the server is only asked once it is
+  // due, and usually answers that nothing changed
+  static GifAnimation *decoded = nullptr;
+  AnimationStore &store = networkManager.getAnimationStore();
+  bool changed = gifOnFlash;
+  gifOnFlash = false;
+  if (!decoded && networkManager.isConnected() && store.isDue())
+  {
+    changed = store.fetch(WordClock::GIF_URL) == AnimationStore::UPDATED || changed;
+  }
+
+  // Decoding takes a while, so it happens here and the render task only
+  // swaps in the finished frames
+  if (changed)
+  {
+    delete decoded;
+    decoded = gifPlayer.decode(LittleFS, AnimationStore::PATH);
   }
+
+  // A full queue is retried on the next tick
+  if (decoded && networkEvents.push({NET_EVENT_GIF_READY, decoded}))
+  {
+    decoded = nullptr;
+    wakeRenderTask();
+  }
+}
+
+void networkStatsTask()
+{
+  SERIAL_PRINTLN("Network core:");
+  networkScheduler.printStats();
+}
+
+void networkTaskMain(void *parameter)
+{
+  // Only starts the connection; networkTask follows it through update()
+  networkManager.setup();
+  postNetworkState();
+
+  networkTaskId = networkScheduler.addTask("network", networkTask, NETWORK_TASK_MS);
+  networkScheduler.addTask("ntp", ntpTask, NTP_TASK_MS);
+  networkScheduler.addTask("gif", gifTask, GIF_TASK_MS);
+  networkScheduler.addTask("stats", networkStatsTask, STATS_TASK_MS);
+
+  for (;;)
+  {
+    unsigned long idleMs = networkScheduler.run();
+    if (idleMs > 0)
+    {
+      delay(idleMs);
+    }
+  }
+}
+
+
+#if LIGHT_SLEEP_ENABLE
+void configureLightSleep()
+{
+#if CONFIG_PM_ENABLE
+  // Let the chip light-sleep whenever both cores are idle. WiFi stays associated
+  // through modem sleep (the Arduino default) and the button wakes the chip.
+  esp_pm_config_esp32_t pm = {};
+  pm.max_freq_mhz = 240;
+  pm.min_freq_mhz = 80;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+  pm.light_sleep_enable = true;
+#else
+  SERIAL_PRINTLN("Tickless idle not enabled in this framework build, only scaling the CPU clock");
+#endif
+  if (esp_pm_configure(&pm) != ESP_OK)
+  {
+    SERIAL_PRINTLN("esp_pm_configure failed, running without power management");
+    return;
+  }
+  gpio_wakeup_enable((gpio_num_t)RESET_BUTTON_PIN, GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+#else
+  SERIAL_PRINTLN("LIGHT_SLEEP_ENABLE needs CONFIG_PM_ENABLE in the framework build");
+#endif
+}
+#endif
+
+void setup()
+{
+  initSerial();
+  BootTrace::mark("setup");
+  
+  // Initialize display first for startup progress indicators
+  clockDisplayHAL.setup();
+#if LED_OUTPUT_BENCHMARK
+  clockDisplayHAL.benchmarkOutput(100);
+#endif
+  clockDisplayHAL.clearPixels(true);
+  
+  // Progress LED 1: Serial initialized
+  SERIAL_PRINTLN("=== STARTUP: Step 1 - Serial OK ===");
+  clockDisplayHAL.setPixel(0, 0, 0x0000FF); // Blue
+  clockDisplayHAL.present();
+  BootTrace::mark("display ready");
+  
+  // The clock face reads time through the NTP drift model
+  wordClock.setTimeSource(networkManager.getTimeSource());
+  gifPlayer.setScaleMode((GifPlayer::ScaleMode)GIF_SCALE_MODE);
+  
+  // Downloaded animations are kept on flash, not in RAM
+  if (LittleFS.begin(true))
+  {
+    networkManager.getAnimationStore().begin();
+    gifOnFlash = networkManager.getAnimationStore().hasAnimation();
+  }
+  else
+  {
+    SERIAL_PRINTLN("LittleFS mount failed, no animations");
+  }
+  
+  // After a warm reboot the render task can show the time before WiFi is back
+  timeCache.begin();
+  networkManager.setTimeCache(&timeCache);
+  networkManager.applyStoredTimezone();
+  wordClock.setTimeZone(networkManager.getTimezone());
+  if (timeCache.restore())
+  {
+    BootTrace::mark("time restored");
+  }
+  
+  // Setup reset button with internal pull-up
+  pinMode(RESET_BUTTON_PIN, INPUT_PULLUP);
+  networkManager.setResetButtonPin(RESET_BUTTON_PIN);
+  attachInterrupt(digitalPinToInterrupt(RESET_BUTTON_PIN), onResetButtonPressed, FALLING);
+#if LIGHT_SLEEP_ENABLE
+  configureLightSleep();
+#endif
+  
+  // Progress LED 2: Setting up callbacks
+  SERIAL_PRINTLN("=== STARTUP: Step 2 - Setting callbacks ===");
+  clockDisplayHAL.setPixel(1, 0, 0x0000FF); // Blue
+  clockDisplayHAL.present();
+  networkManager.setDisplayCommandQueue(&displayCommands);
+  
+  // Progress LED 3: Starting network manager
+  SERIAL_PRINTLN("=== STARTUP: Step 3 - Starting network and render tasks ===");
+  clockDisplayHAL.setPixel(2, 0, 0x00FF00); // Green
+  clockDisplayHAL.present();
+  
+  // NetworkManager connects from the network task; the render task watches the reset button
+  xTaskCreatePinnedToCore(networkTaskMain, "network", NETWORK_TASK_STACK, nullptr, NETWORK_TASK_PRIORITY, nullptr, NETWORK_CORE);
+  xTaskCreatePinnedToCore(renderTaskMain, "render", RENDER_TASK_STACK, nullptr, RENDER_TASK_PRIORITY, &renderTaskHandle, RENDER_CORE);
+  BootTrace::mark("tasks started");
+  SERIAL_PRINTLN("=== STARTUP: COMPLETE ===");
+}
+
+void loop()
+{
+  // All work happens in the render and network tasks
+  vTaskDelete(nullptr);
 }
@@ -0,0 +1,103 @@
+#include "FlipMeasure.h"
+#include <time.h>
+#include "ClockDisplayHAL.h"
+#include "GifPlayer.h"
+#include "NtpClient.h"
+#include "TimeSource.h"
+#include "WordClock.h"
+#include "SimOutput.h"
+
+static const int64_t LEAD_US = 2000000; // Boundary this far ahead of each measurement
+
+// Host clock moved by a settable amount, to bring the next boundary close
+class ShiftedClock : public SystemTimeSource
+{
+public:
+    int64_t shiftUs = 0;
+    int64_t nowUs() override { return SystemTimeSource::nowUs() + shiftUs; }
+};
+
+// Like esp_timer_start_once(): sleep to the microsecond
+static void sleepUs(int64_t us)
+{
+    struct timespec wait;
+    wait.tv_sec = us / 1000000;
+    wait.tv_nsec = (us % 1000000) * 1000;
+    nanosleep(&wait, nullptr);
+}
+
+// NTP minus host clock from the fastest server, false if none answered
+static bool probeOffset(NtpClient &client, int64_t *offsetUs)
+{
+    if (!client.startPoll())
+        return false;
+    while (!client.update())
+        delay(1);
+    int8_t best = client.getBestServer();
+    if (best < 0)
+        return false;
+    *offsetUs = client.getServer(best).offsetUs;
+    return true;
+}
+
+int runFlipMeasure(long flips, const char *ntpServers)
+{
+    SimOutput *output = new SimOutput(SimOutput::SIM_MEMORY);
+    ClockDisplayHAL clockDisplayHAL(0, 255);
+    clockDisplayHAL.setOutput(output);
+    clockDisplayHAL.setup();
+    GifPlayer gifPlayer(&clockDisplayHAL);
+    WordClock wordClock(&clockDisplayHAL, &gifPlayer);
+    ShiftedClock clock;
+    wordClock.setTimeSource(&clock);
+    wordClock.displayTime(); // First frame is not a flip
+
+    NtpClient ntp;
+    if (ntpServers)
+        ntp.setServers(ntpServers);
+    printf("Measuring %ld flips, NTP reference: %s\n", flips, ntpServers ? ntpServers : "host clock");
+
+    int64_t totalLocalUs = 0, maxLocalUs = 0, totalNtpUs = 0, maxNtpUs = 0;
+    long wakeups = 0, ntpSamples = 0;
+    for (long i = 0; i < flips; i++)
+    {
+        clock.shiftUs += wordClock.usUntilNextFrame() - LEAD_US;
+
+        // Same loop as the render task: sleep to the boundary, draw, re-arm if early
+        uint32_t before = wordClock.getFlipCount();
+        while (wordClock.getFlipCount() == before)
+        {
+            sleepUs(wordClock.usUntilNextFrame());
+            wakeups++;
+            wordClock.displayTime();
+        }
+
+        int64_t localUs = wordClock.getLastFlipErrorUs();
+        totalLocalUs += localUs;
+        if (localUs > maxLocalUs)
+            maxLocalUs = localUs;
+        printf("flip %2ld: %7.3f ms after the boundary on the local clock", i + 1, localUs / 1000.0);
+
+        int64_t offsetUs = 0;
+        if (!ntpServers || probeOffset(ntp, &offsetUs))
+        {
+            int64_t ntpUs = localUs + offsetUs;
+            totalNtpUs += ntpUs;
+            if (llabs(ntpUs) > maxNtpUs)
+                maxNtpUs = llabs(ntpUs);
+            ntpSamples++;
+            printf(", %7.3f ms in NTP time\n", ntpUs / 1000.0);
+        }
+        else
+        {
+            printf(", no NTP reply\n");
+        }
+    }
+
+    printf("Local clock: avg %.3f ms, max %.3f ms after the boundary\n", totalLocalUs / 1000.0 / flips,
+           maxLocalUs / 1000.0);
+    if (ntpSamples)
+        printf("NTP time:    avg %.3f ms, max |%.3f| ms\n", totalNtpUs / 1000.0 / ntpSamples, maxNtpUs / 1000.0);
+    printf("Wake-ups per flip: %.2f\n", (double)wakeups / flips);
+    return 0;
+}
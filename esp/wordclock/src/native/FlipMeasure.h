@@ -0,0 +1,13 @@
+#ifndef FLIP_MEASURE_H
+#define FLIP_MEASURE_H
+
+// Measures how far frame flips land from their five-minute boundary on the
+// real host clock, armed the way the render task arms them (sleep to the
+// microsecond, re-arm when woken early). The clock WordClock sees is shifted
+// so a boundary comes every couple of seconds. With ntpServers set, each flip
+// is followed by an NTP probe and the error is also given relative to NTP
+// time; otherwise the host clock counts as NTP time. Prints one line per flip
+// and a summary.
+int runFlipMeasure(long flips, const char *ntpServers);
+
+#endif
@@ -0,0 +1,241 @@
+#include "GoldenCheck.h"
+#include <map>
+#include <string>
+#include "ClockDisplayHAL.h"
+#include "GifPlayer.h"
+#include "TimeSource.h"
+#include "WebConfigServer.h"
+#include "WordClock.h"
+#include "SimOutput.h"
+
+static const time_t JAN_15_2026_NOON_UTC = 1768478400;
+static const time_t JUL_15_2026_NOON_UTC = 1784116800;
+
+struct GoldenRenderer
+{
+    SimOutput *output;
+    ClockDisplayHAL hal;
+    GifPlayer gifPlayer;
+    WordClock wordClock;
+    VirtualClock clock;
+
+    GoldenRenderer()
+        : output(new SimOutput(SimOutput::SIM_MEMORY)), hal(0, 255), gifPlayer(&hal),
+          wordClock(&hal, &gifPlayer)
+    {
+        hal.setOutput(output);
+        hal.setup();
+        wordClock.setTimeSource(&clock);
+    }
+
+    // Lit LEDs after rendering t in the current TZ
+    LedMask render(time_t t)
+    {
+        clock.set(t);
+        wordClock.displayTime();
+        LedMask mask;
+        const uint32_t *frame = output->getFrame();
+        for (uint16_t i = 0; i < ClockDisplayHAL::NUM_LEDS; i++)
+        {
+            if (frame[i])
+                mask.set(i);
+        }
+        return mask;
+    }
+};
+
+static std::string maskToHex(const LedMask &mask)
+{
+    char text[LedMask::NUM_WORDS * 8 + 1];
+    char *p = text;
+    for (int i = LedMask::NUM_WORDS - 1; i >= 0; i--)
+    {
+        p += sprintf(p, "%08x", mask.bits[i]);
+    }
+    return text;
+}
+
+static std::string frameWords(int hour, int minute)
+{
+    const ClockFrame &frame = CLOCK_FRAMES[clockFrameIndex(hour, minute)];
+    std::string words;
+    for (uint8_t i = 0; i < frame.wordCount; i++)
+    {
+        if (i)
+            words += ' ';
+        words += WORD_SPANS[frame.words[i]].word;
+    }
+    return words;
+}
+
+static void printLedDiff(const std::string &expectedHex, const LedMask &actual)
+{
+    LedMask expected;
+    for (int i = 0; i < LedMask::NUM_WORDS; i++)
+    {
+        std::string word = expectedHex.substr((LedMask::NUM_WORDS - 1 - i) * 8, 8);
+        expected.bits[i] = strtoul(word.c_str(), nullptr, 16);
+    }
+    printf("        missing LEDs:");
+    for (uint16_t i = 0; i < LedMask::NUM_BITS; i++)
+    {
+        if (expected.test(i) && !actual.test(i))
+            printf(" %u", i);
+    }
+    printf("\n        extra LEDs:  ");
+    for (uint16_t i = 0; i < LedMask::NUM_BITS; i++)
+    {
+        if (!expected.test(i) && actual.test(i))
+            printf(" %u", i);
+    }
+    printf("\n");
+}
+
+// key -> rest of line ("<mask> <words>" or "<mask> <mask>"), '#' lines skipped
+static bool loadGolden(const std::string &path, std::map<std::string, std::string> &entries)
+{
+    FILE *file = fopen(path.c_str(), "r");
+    if (!file)
+    {
+        fprintf(stderr, "Cannot open %s (run with --update-golden to create it)\n", path.c_str());
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), file))
+    {
+        line[strcspn(line, "\r\n")] = 0;
+        char *space = strchr(line, ' ');
+        if (line[0] == '#' || !space)
+            continue;
+        *space = 0;
+        entries[line] = space + 1;
+    }
+    fclose(file);
+    return true;
+}
+
+static int checkFrames(GoldenRenderer &renderer, const std::string &path, bool update)
+{
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    renderer.wordClock.setTimeZone("UTC0");
+
+    std::map<std::string, std::string> golden;
+    FILE *out = nullptr;
+    if (update)
+    {
+        out = fopen(path.c_str(), "w");
+        if (!out)
+        {
+            fprintf(stderr, "Cannot write %s\n", path.c_str());
+            return 1;
+        }
+        fprintf(out, "# Golden clock frames: HH:MM <lit LEDs, hex, bit 0 = strip LED 0> <words>\n");
+        fprintf(out, "# Regenerate with --check=golden --update-golden after an intended layout change\n");
+    }
+    else if (!loadGolden(path, golden))
+    {
+        return 1;
+    }
+
+    int failures = 0;
+    for (int minuteOfDay = 0; minuteOfDay < 24 * 60; minuteOfDay++)
+    {
+        int hour = minuteOfDay / 60;
+        int minute = minuteOfDay % 60;
+        char key[6];
+        snprintf(key, sizeof(key), "%02d:%02d", hour, minute);
+
+        LedMask mask = renderer.render(JAN_15_2026_NOON_UTC - 12 * 3600 + minuteOfDay * 60);
+        std::string hex = maskToHex(mask);
+        if (out)
+        {
+            fprintf(out, "%s %s %s\n", key, hex.c_str(), frameWords(hour, minute).c_str());
+            continue;
+        }
+
+        auto entry = golden.find(key);
+        if (entry == golden.end())
+        {
+            printf("FAIL  %s missing from golden file\n", key);
+            failures++;
+        }
+        else if (entry->second.compare(0, hex.length(), hex) != 0)
+        {
+            printf("FAIL  %s expected %s\n", key, entry->second.c_str());
+            printf("      %s   got %s %s\n", key, hex.c_str(), frameWords(hour, minute).c_str());
+            printLedDiff(entry->second, mask);
+            failures++;
+        }
+    }
+
+    if (out)
+        fclose(out);
+    printf("Frames: %d of 1440 minutes differ\n", failures);
+    return failures;
+}
+
+static int checkTimezones(GoldenRenderer &renderer, const std::string &path, bool update)
+{
+    std::map<std::string, std::string> golden;
+    FILE *out = nullptr;
+    if (update)
+    {
+        out = fopen(path.c_str(), "w");
+        if (!out)
+        {
+            fprintf(stderr, "Cannot write %s\n", path.c_str());
+            return 1;
+        }
+        fprintf(out, "# Dropdown time zones: <TZ> <lit LEDs at 2026-01-15 12:00 UTC> <at 2026-07-15 12:00 UTC>\n");
+    }
+    else if (!loadGolden(path, golden))
+    {
+        return 1;
+    }
+
+    int failures = 0;
+    for (int i = 0; i < WebConfigServer::getTimezoneCount(); i++)
+    {
+        const char *tz = WebConfigServer::TIMEZONES[i].tz;
+        setenv("TZ", tz, 1);
+        tzset();
+        renderer.wordClock.setTimeZone(tz);
+        std::string result = maskToHex(renderer.render(JAN_15_2026_NOON_UTC)) + " " +
+                             maskToHex(renderer.render(JUL_15_2026_NOON_UTC));
+        if (out)
+        {
+            fprintf(out, "%s %s\n", tz, result.c_str());
+            continue;
+        }
+
+        auto entry = golden.find(tz);
+        if (entry == golden.end() || entry->second != result)
+        {
+            printf("FAIL  TZ %s (%s)\n", tz, WebConfigServer::TIMEZONES[i].label);
+            printf("      expected %s\n", entry == golden.end() ? "(missing)" : entry->second.c_str());
+            printf("      got      %s\n", result.c_str());
+            failures++;
+        }
+    }
+
+    if (out)
+        fclose(out);
+    printf("Time zones: %d of %d differ\n", failures, WebConfigServer::getTimezoneCount());
+    return failures;
+}
+
+int runGoldenCheck(const char *goldenDir, bool update)
+{
+    GoldenRenderer renderer;
+    std::string dir = goldenDir;
+    int failures = checkFrames(renderer, dir + "/clock_frames.txt", update) +
+                   checkTimezones(renderer, dir + "/timezones.txt", update);
+    if (update)
+    {
+        printf("Golden files written to %s\n", goldenDir);
+        return 0;
+    }
+    printf(failures ? "Golden check FAILED\n" : "Golden check passed\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,11 @@
+#ifndef GOLDEN_CHECK_H
+#define GOLDEN_CHECK_H
+
+// Renders every minute of the day and the dropdown time zones through
+// WordClock and compares the lit LEDs with the masks checked in under
+// goldenDir (clock_frames.txt, timezones.txt). Prints one line per differing
+// minute/zone and returns non-zero on any difference. With update set, the
+// golden files are rewritten from the current output instead.
+int runGoldenCheck(const char *goldenDir, bool update);
+
+#endif
@@ -0,0 +1,250 @@
+#include "NtpCheck.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include "NtpClient.h"
+#include "TimeSync.h"
+
+static const int64_t SERVER_OFFSET_US = 250000; // Fake servers run a quarter second ahead of us
+static const uint64_t NTP_UNIX_OFFSET = 2208988800ULL;
+
+// SNTP server on a localhost UDP port, answering from its own thread
+class FakeNtpServer
+{
+public:
+    std::atomic<int> delayMs{0};       // Simulated round trip, half on the way in and half out
+    std::atomic<bool> silent{false};   // Swallow requests
+    std::atomic<uint8_t> stratum{2};   // 0 = kiss-o'-death
+    std::atomic<int> requests{0};
+
+    bool start()
+    {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in local = {};
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t size = sizeof(local);
+        if (fd < 0 || bind(fd, (struct sockaddr *)&local, size) < 0 ||
+            getsockname(fd, (struct sockaddr *)&local, &size) < 0)
+            return false;
+        port = ntohs(local.sin_port);
+        thread = std::thread([this] { serve(); });
+        return true;
+    }
+
+    ~FakeNtpServer()
+    {
+        stopping = true;
+        if (thread.joinable())
+            thread.join();
+        if (fd >= 0)
+            close(fd);
+    }
+
+    String spec(const char *host = "127.0.0.1")
+    {
+        return String(host) + ":" + String(port);
+    }
+
+private:
+    int fd = -1;
+    uint16_t port = 0;
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+
+    static void writeStamp(uint8_t *p, uint64_t stamp)
+    {
+        for (int i = 7; i >= 0; i--)
+        {
+            p[i] = stamp & 0xFF;
+            stamp >>= 8;
+        }
+    }
+
+    static uint64_t nowStamp()
+    {
+        struct timeval now;
+        gettimeofday(&now, nullptr);
+        int64_t us = (int64_t)now.tv_sec * 1000000 + now.tv_usec + SERVER_OFFSET_US;
+        return ((uint64_t)(us / 1000000 + NTP_UNIX_OFFSET) << 32) | (((uint64_t)(us % 1000000) << 32) / 1000000);
+    }
+
+    void serve()
+    {
+        while (!stopping)
+        {
+            struct pollfd waiting = {fd, POLLIN, 0};
+            if (::poll(&waiting, 1, 20) <= 0)
+                continue;
+            uint8_t packet[48];
+            struct sockaddr_in client = {};
+            socklen_t size = sizeof(client);
+            if (recvfrom(fd, packet, sizeof(packet), 0, (struct sockaddr *)&client, &size) != sizeof(packet))
+                continue;
+            requests++;
+            if (silent)
+                continue;
+
+            uint8_t reply[48] = {};
+            reply[0] = 0x24; // LI 0, version 4, mode 4 (server)
+            reply[1] = stratum;
+            memcpy(reply + 24, packet + 40, 8); // Originate = the client's transmit
+            usleep(delayMs * 500);
+            writeStamp(reply + 32, nowStamp());
+            writeStamp(reply + 40, nowStamp());
+            usleep(delayMs * 500);
+            sendto(fd, reply, sizeof(reply), 0, (struct sockaddr *)&client, size);
+        }
+    }
+};
+
+static int failures = 0;
+
+static void expect(bool condition, const char *scenario, const char *what)
+{
+    if (!condition)
+    {
+        printf("FAIL  %s: %s\n", scenario, what);
+        failures++;
+    }
+}
+
+// Same cadence as the network task while replies are outstanding
+static unsigned long runPoll(NtpClient &client)
+{
+    unsigned long startMs = millis();
+    if (!client.startPoll())
+        return 0;
+    while (!client.update())
+        delay(1);
+    return millis() - startMs;
+}
+
+static bool near(int64_t value, int64_t expected, int64_t tolerance)
+{
+    return value >= expected - tolerance && value <= expected + tolerance;
+}
+
+static void checkSelection(FakeNtpServer &slow, FakeNtpServer &fast, FakeNtpServer &dead, FakeNtpServer &kiss)
+{
+    const char *name = "fastest healthy server";
+    TimeSync sync;
+    // Listed slowest first: preference order must not beat a faster reply
+    sync.begin("UTC0", slow.spec() + ", " + fast.spec("localhost") + "," + dead.spec() + "," + kiss.spec(), 0);
+    unsigned long startMs = millis();
+    while (!sync.update() && millis() - startMs < 5000)
+        delay(1);
+    unsigned long tookMs = millis() - startMs;
+
+    NtpClient &client = sync.getClient();
+    expect(client.getServerCount() == 4, name, "four servers parsed");
+    expect(sync.isSynced(), name, "should sync");
+    expect(sync.getSourceIndex() == 1, name, "the fast server should be picked");
+    expect(tookMs <= NtpClient::REPLY_TIMEOUT_MS + 200, name, "silent server should only cost the reply timeout");
+    expect(near(sync.getLastOffsetMs(), SERVER_OFFSET_US / 1000, 5), name, "offset should match the server clock");
+
+    const NtpServer &fastStats = client.getServer(1);
+    const NtpServer &slowStats = client.getServer(0);
+    expect(fastStats.healthy && fastStats.rttUs < 10000, name, "fast server RTT under 10 ms");
+    expect(slowStats.healthy && near(slowStats.rttUs, 40000, 15000), name, "slow server RTT about 40 ms");
+    expect(near(slowStats.offsetUs, SERVER_OFFSET_US, 5000), name, "slow server offset independent of its delay");
+    expect(!client.getServer(2).healthy && client.getServer(2).misses == 1, name, "silent server counted as a miss");
+    expect(!client.getServer(3).healthy && client.getServer(3).stratum == 0, name, "kiss-o'-death rejected");
+    expect(dead.requests == 1 && kiss.requests == 1, name, "every server asked once");
+}
+
+static void checkFailover(FakeNtpServer &slow, FakeNtpServer &fast)
+{
+    const char *name = "failover";
+    NtpClient client;
+    client.setServers(fast.spec() + "," + slow.spec());
+    runPoll(client);
+    expect(client.getBestServer() == 0, name, "fast server first");
+
+    fast.silent = true;
+    unsigned long tookMs = runPoll(client);
+    expect(client.getBestServer() == 1, name, "slow server takes over in the same poll");
+    expect(tookMs <= NtpClient::REPLY_TIMEOUT_MS + 200, name, "no wait beyond the reply timeout");
+
+    fast.silent = false;
+    runPoll(client);
+    expect(client.getBestServer() == 0, name, "fast server back once it answers");
+    expect(client.getServer(0).misses == 0, name, "misses reset by a good reply");
+}
+
+static void checkNobodyAnswers(FakeNtpServer &dead)
+{
+    const char *name = "no answer";
+    NtpClient client;
+    client.setServers(dead.spec() + ",no-such-host.invalid");
+    unsigned long tookMs = runPoll(client);
+    expect(client.getBestServer() < 0, name, "no server to pick");
+    expect(tookMs >= NtpClient::REPLY_TIMEOUT_MS && tookMs <= NtpClient::REPLY_TIMEOUT_MS + 200, name,
+           "poll should end at the reply timeout");
+    expect(client.getServer(1).misses == 1, name, "unresolvable name counted as a miss");
+
+    for (uint8_t i = 1; i < NtpClient::RESOLVE_AFTER_MISSES; i++)
+        runPoll(client);
+    expect(client.getServer(0).misses == NtpClient::RESOLVE_AFTER_MISSES, name, "misses accumulate");
+    expect((uint32_t)client.getServer(0).address == 0, name, "address dropped for a fresh lookup");
+}
+
+static void checkResolveBackoff()
+{
+    const char *name = "resolve back-off";
+    NtpClient client;
+    client.setServers("no-such-host.invalid");
+    expect(client.startPoll(), name, "poll waits for the lookup");
+    unsigned long startMs = millis();
+    while (!client.update())
+        delay(1);
+    expect(millis() - startMs <= NtpClient::REPLY_TIMEOUT_MS + 200, name, "lookup should not hold up the poll");
+    expect(client.getServer(0).resolveSkips == NtpClient::RESOLVE_RETRY_POLLS, name, "failed name backs off");
+
+    uint8_t skipped = 0;
+    while (!client.startPoll() && skipped < 255)
+        skipped++;
+    expect(skipped == NtpClient::RESOLVE_RETRY_POLLS, name, "looked up again only after the back-off");
+    while (!client.update())
+        delay(1);
+}
+
+static void checkEmptyList()
+{
+    const char *name = "server list parsing";
+    NtpClient client;
+    client.setServers(" , ,");
+    expect(client.getServerCount() == 0, name, "blank entries skipped");
+    expect(!client.startPoll(), name, "nothing to poll");
+    client.setServers("a,b,c,d,e,f");
+    expect(client.getServerCount() == NtpClient::MAX_SERVERS, name, "list capped at MAX_SERVERS");
+    client.setServers("10.0.0.1:1123");
+    expect(client.getServer(0).port == 1123 && client.getServer(0).host == "10.0.0.1", name, "host:port split");
+}
+
+int runNtpCheck()
+{
+    failures = 0;
+    FakeNtpServer slow, fast, dead, kiss;
+    slow.delayMs = 40;
+    dead.silent = true;
+    kiss.stratum = 0;
+    if (!slow.start() || !fast.start() || !dead.start() || !kiss.start())
+    {
+        printf("Cannot open localhost UDP sockets\n");
+        return 1;
+    }
+
+    checkSelection(slow, fast, dead, kiss);
+    checkFailover(slow, fast);
+    checkNobodyAnswers(dead);
+    checkResolveBackoff();
+    checkEmptyList();
+
+    printf(failures ? "NTP check failed\n" : "NTP check passed\n");
+    return failures ? 1 : 0;
+}
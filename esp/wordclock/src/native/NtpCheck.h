@@ -0,0 +1,11 @@
+#ifndef NTP_CHECK_H
+#define NTP_CHECK_H
+
+// Starts fake NTP servers on localhost (fast, slow, silent, kiss-o'-death) and
+// runs NtpClient and TimeSync against them through the real UDP shim: the
+// fastest healthy server must win, offsets and round trips must match what
+// the fakes simulate, and losing a server must fail over within one poll.
+// Prints one line per failed expectation and returns non-zero on any.
+int runNtpCheck();
+
+#endif
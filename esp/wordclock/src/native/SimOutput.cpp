@@ -0,0 +1,89 @@
+#include "SimOutput.h"
+
+SimOutput::SimOutput(Mode mode, const char *ppmDirectory)
+    : mode(mode), ppmDirectory(ppmDirectory), frame(), frameCount(0)
+{
+}
+
+void SimOutput::begin()
+{
+}
+
+const char *SimOutput::getName()
+{
+    return "Simulator";
+}
+
+uint32_t SimOutput::getPixel(uint8_t x, uint8_t y)
+{
+    if (x >= ClockDisplayHAL::WIDTH || y >= ClockDisplayHAL::HEIGHT)
+    {
+        return 0;
+    }
+    return frame[STRIP_INDEX.index[y][x]];
+}
+
+void SimOutput::write(const uint32_t *pixels, uint16_t numPixels)
+{
+    if (numPixels > ClockDisplayHAL::NUM_LEDS)
+    {
+        numPixels = ClockDisplayHAL::NUM_LEDS;
+    }
+    memcpy(frame, pixels, numPixels * sizeof(uint32_t));
+    frameCount++;
+
+    if (mode == SIM_TERMINAL)
+    {
+        drawTerminal();
+    }
+    else if (mode == SIM_PPM)
+    {
+        writePPM();
+    }
+}
+
+void SimOutput::drawTerminal()
+{
+    printf("frame %u\n", frameCount);
+    for (uint8_t y = 0; y < ClockDisplayHAL::HEIGHT; y++)
+    {
+        for (uint8_t x = 0; x < ClockDisplayHAL::WIDTH; x++)
+        {
+            uint32_t c = getPixel(x, y);
+            if (c)
+            {
+                printf("\x1b[38;2;%u;%u;%um██", (c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF);
+            }
+            else
+            {
+                printf("\x1b[38;2;60;60;60m··");
+            }
+        }
+        printf("\x1b[0m\n");
+    }
+    fflush(stdout);
+}
+
+void SimOutput::writePPM()
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%06u.ppm", ppmDirectory.c_str(), frameCount);
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "SimOutput: cannot write %s\n", path);
+        return;
+    }
+
+    fprintf(file, "P6\n%u %u\n255\n", ClockDisplayHAL::WIDTH * PPM_SCALE, ClockDisplayHAL::HEIGHT * PPM_SCALE);
+    for (uint16_t py = 0; py < ClockDisplayHAL::HEIGHT * PPM_SCALE; py++)
+    {
+        for (uint16_t px = 0; px < ClockDisplayHAL::WIDTH * PPM_SCALE; px++)
+        {
+            uint32_t c = getPixel(px / PPM_SCALE, py / PPM_SCALE);
+            uint8_t rgb[3] = {(uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c};
+            fwrite(rgb, 1, sizeof(rgb), file);
+        }
+    }
+    fclose(file);
+}
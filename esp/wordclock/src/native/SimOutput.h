@@ -0,0 +1,40 @@
+#ifndef SIM_OUTPUT_H
+#define SIM_OUTPUT_H
+
+#include "LedOutput.h"
+#include "ClockDisplayHAL.h"
+
+// Simulated LED strip for host builds. Every frame is kept in memory and can
+// additionally be drawn on the terminal (24-bit ANSI color) or written as PPM files.
+class SimOutput : public LedOutput
+{
+public:
+    enum Mode
+    {
+        SIM_MEMORY,   // Keep frames in memory only
+        SIM_TERMINAL, // Draw each frame to stdout
+        SIM_PPM       // Write frame_NNNNNN.ppm files into a directory
+    };
+
+    SimOutput(Mode mode = SIM_MEMORY, const char *ppmDirectory = ".");
+    void begin() override;
+    void write(const uint32_t *pixels, uint16_t numPixels) override;
+    const char *getName() override;
+
+    const uint32_t *getFrame() { return frame; } // Strip order, 0xRRGGBB
+    uint32_t getFrameCount() { return frameCount; }
+    uint32_t getPixel(uint8_t x, uint8_t y);
+
+private:
+    static const uint8_t PPM_SCALE = 8; // Each LED becomes an 8x8 block
+
+    Mode mode;
+    String ppmDirectory;
+    uint32_t frame[ClockDisplayHAL::NUM_LEDS];
+    uint32_t frameCount;
+
+    void drawTerminal();
+    void writePPM();
+};
+
+#endif
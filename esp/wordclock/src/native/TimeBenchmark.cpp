@@ -0,0 +1,82 @@
+#include "TimeBenchmark.h"
+#include "ClockDisplayHAL.h"
+#include "GifPlayer.h"
+#include "TimeSource.h"
+#include "WordClock.h"
+#include "SimOutput.h"
+
+static time_t localMidnight(int year, int month, int day)
+{
+    struct tm start = {};
+    start.tm_year = year - 1900;
+    start.tm_mon = month - 1;
+    start.tm_mday = day;
+    start.tm_isdst = -1;
+    return mktime(&start);
+}
+
+int runTimeBenchmark(const char *span, const char *tz)
+{
+    long minutes;
+    if (strcmp(span, "day") == 0)
+        minutes = 24 * 60;
+    else if (strcmp(span, "year") == 0)
+        minutes = 365L * 24 * 60;
+    else
+    {
+        fprintf(stderr, "Unknown benchmark '%s', expected day or year\n", span);
+        return 1;
+    }
+
+    setenv("TZ", tz, 1);
+    tzset();
+
+    SimOutput *output = new SimOutput(SimOutput::SIM_MEMORY);
+    ClockDisplayHAL clockDisplayHAL(0, 255);
+    clockDisplayHAL.setOutput(output);
+    clockDisplayHAL.setup();
+    GifPlayer gifPlayer(&clockDisplayHAL);
+    WordClock wordClock(&clockDisplayHAL, &gifPlayer);
+
+    VirtualClock clock(localMidnight(2026, 1, 1));
+    wordClock.setTimeSource(&clock);
+    wordClock.setTimeZone(tz);
+
+    const uint32_t framesBefore = output->getFrameCount();
+    unsigned long totalMicros = 0;
+    unsigned long maxMicros = 0;
+    int dstTransitions = 0;
+    int lastIsDst = -1;
+
+    for (long i = 0; i < minutes; i++)
+    {
+        unsigned long start = micros();
+        wordClock.displayTime();
+        unsigned long elapsed = micros() - start;
+        totalMicros += elapsed;
+        if (elapsed > maxMicros)
+            maxMicros = elapsed;
+
+        struct tm local;
+        clock.getLocalTime(&local);
+        if (lastIsDst >= 0 && local.tm_isdst != lastIsDst)
+        {
+            char text[32];
+            strftime(text, sizeof(text), "%Y-%m-%d %H:%M %Z", &local);
+            printf("DST transition -> %s\n", text);
+            dstTransitions++;
+        }
+        lastIsDst = local.tm_isdst;
+
+        clock.advance(60);
+    }
+
+    const uint32_t frames = output->getFrameCount() - framesBefore;
+    printf("Benchmark %s (TZ=%s)\n", span, tz);
+    printf("  minutes simulated : %ld\n", minutes);
+    printf("  frames presented  : %u (expected about %ld)\n", frames, minutes / 5);
+    printf("  DST transitions   : %d\n", dstTransitions);
+    printf("  displayTime()     : avg %.2f us, max %lu us\n", (double)totalMicros / minutes, maxMicros);
+    printf("  total             : %.1f ms\n", totalMicros / 1000.0);
+    return 0;
+}
@@ -0,0 +1,9 @@
+#ifndef TIME_BENCHMARK_H
+#define TIME_BENCHMARK_H
+
+// Drives WordClock from a VirtualClock, one call per simulated minute.
+// span is "day" (1440 minutes) or "year" (every minute of 2026, covering the
+// DST transitions of tz). Prints frame-change counts and render timings.
+int runTimeBenchmark(const char *span, const char *tz);
+
+#endif
@@ -0,0 +1,133 @@
+#include "TzCheck.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "TimeZone.h"
+#include "WebConfigServer.h"
+
+static const time_t RANGE_START = 1735689600; // 2025-01-01 00:00 UTC
+static const time_t RANGE_END = 2366841600;   // 2045-01-01 00:00 UTC
+static const int RANDOM_SAMPLES = 20000;
+static const int MAX_REPORTED = 5; // Per zone
+
+static int failures;
+static int zoneFailures;
+
+static bool sameFields(const struct tm &a, const struct tm &b)
+{
+    return a.tm_year == b.tm_year && a.tm_mon == b.tm_mon && a.tm_mday == b.tm_mday && a.tm_hour == b.tm_hour &&
+           a.tm_min == b.tm_min && a.tm_sec == b.tm_sec && a.tm_wday == b.tm_wday && a.tm_yday == b.tm_yday &&
+           (a.tm_isdst > 0) == (b.tm_isdst > 0);
+}
+
+static void compare(TimeZone &zone, const char *tz, time_t t)
+{
+    struct tm expected, actual;
+    localtime_r(&t, &expected);
+    if (!zone.toLocal(t, &actual) || !sameFields(expected, actual))
+    {
+        failures++;
+        if (++zoneFailures > MAX_REPORTED)
+            return;
+        char want[32], got[32];
+        strftime(want, sizeof(want), "%Y-%m-%d %H:%M:%S", &expected);
+        strftime(got, sizeof(got), "%Y-%m-%d %H:%M:%S", &actual);
+        printf("FAIL  TZ %s at %lld: libc %s dst=%d, TimeZone %s dst=%d\n", tz, (long long)t, want,
+               expected.tm_isdst, got, actual.tm_isdst);
+    }
+}
+
+// Seconds east of UTC per libc
+static long libcOffset(time_t t)
+{
+    struct tm local;
+    localtime_r(&t, &local);
+    return (long)(timegm(&local) - t);
+}
+
+// Last second before libc's offset changes somewhere in (from, to]
+static time_t findTransition(time_t from, time_t to)
+{
+    long before = libcOffset(from);
+    while (to - from > 1)
+    {
+        time_t middle = from + (to - from) / 2;
+        if (libcOffset(middle) == before)
+            from = middle;
+        else
+            to = middle;
+    }
+    return to;
+}
+
+static int checkZone(const char *tz)
+{
+    setenv("TZ", tz, 1);
+    tzset();
+    zoneFailures = 0;
+
+    TimeZone zone;
+    if (!zone.set(tz))
+    {
+        failures++;
+        printf("FAIL  TZ %s not parsed\n", tz);
+        return 0;
+    }
+
+    int transitions = 0;
+    long lastOffset = libcOffset(RANGE_START);
+    for (time_t t = RANGE_START; t < RANGE_END; t += 3600)
+    {
+        compare(zone, tz, t);
+        long offset = libcOffset(t);
+        if (offset != lastOffset)
+        {
+            time_t at = findTransition(t - 3600, t);
+            for (time_t s = at - 2; s <= at + 1; s++)
+                compare(zone, tz, s);
+            if (zone.getOffset(at) != offset)
+            {
+                failures++;
+                printf("FAIL  TZ %s offset after %lld: libc %ld, TimeZone %ld\n", tz, (long long)at, offset,
+                       (long)zone.getOffset(at));
+            }
+            transitions++;
+            lastOffset = offset;
+        }
+    }
+
+    srand(1);
+    for (int i = 0; i < RANDOM_SAMPLES; i++)
+    {
+        time_t t = RANGE_START + (time_t)((double)rand() / RAND_MAX * (RANGE_END - RANGE_START - 1));
+        compare(zone, tz, t);
+    }
+    return transitions;
+}
+
+int runTzCheck()
+{
+    failures = 0;
+    int zones = WebConfigServer::getTimezoneCount();
+    for (int i = 0; i < zones; i++)
+    {
+        const char *tz = WebConfigServer::TIMEZONES[i].tz;
+        int transitions = checkZone(tz);
+        printf("%-40s %3d transitions\n", tz, transitions);
+    }
+
+    // Rule forms the dropdown does not use
+    const char *extra[] = {"<-03>3<-02>,M3.5.0/-2,M10.5.0/-1", "EST5EDT,J60/2,J300/2", "XXX-1YYY-2:30,59,299/25",
+                           "IST-2IDT,M3.4.4/26,M10.5.0"};
+    for (const char *tz : extra)
+    {
+        int transitions = checkZone(tz);
+        printf("%-40s %3d transitions\n", tz, transitions);
+    }
+
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    printf(failures ? "TZ check failed\n" : "TZ check passed\n");
+    return failures ? 1 : 0;
+}
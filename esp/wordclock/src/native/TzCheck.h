@@ -0,0 +1,10 @@
+#ifndef TZ_CHECK_H
+#define TZ_CHECK_H
+
+// Compares TimeZone against the C library's localtime() for every time zone
+// in the web UI dropdown over twenty years: hourly in order, around every
+// transition to the second, and at random instants out of order so the cached
+// window is recomputed backwards too. Prints one line per mismatch.
+int runTzCheck();
+
+#endif
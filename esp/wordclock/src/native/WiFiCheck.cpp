@@ -0,0 +1,268 @@
+#include "WiFiCheck.h"
+#include <vector>
+#include "WiFiStateMachine.h"
+
+static const unsigned long STEP_MS = 100;
+static const unsigned long NEVER = (unsigned long)-1;
+
+// What the access point does with one connection attempt
+struct AttemptOutcome
+{
+    WiFiLinkEvent event;
+    unsigned long afterMs; // NEVER = no event at all, the attempt has to time out
+};
+
+static const AttemptOutcome JOIN = {WIFI_LINK_GOT_IP, 800};
+static const AttemptOutcome REJECT = {WIFI_LINK_DISCONNECTED, 3000}; // Wrong password, AP gone
+static const AttemptOutcome SILENT = {WIFI_LINK_DISCONNECTED, NEVER};
+
+// Mock WiFi event source: answers each WiFi.begin() from a script and can
+// inject unsolicited events (link loss, echoes of our own disconnects)
+class MockRadio
+{
+public:
+    std::vector<AttemptOutcome> script;
+
+    void begin(unsigned long nowMs)
+    {
+        attempts++;
+        AttemptOutcome outcome = nextOutcome < script.size() ? script[nextOutcome++] : SILENT;
+        if (outcome.afterMs != NEVER)
+            inject(nowMs + outcome.afterMs, outcome.event);
+    }
+
+    void inject(unsigned long atMs, WiFiLinkEvent event)
+    {
+        pending.push_back({event, atMs});
+    }
+
+    bool poll(unsigned long nowMs, WiFiLinkEvent &event)
+    {
+        for (size_t i = 0; i < pending.size(); i++)
+        {
+            if (pending[i].afterMs <= nowMs)
+            {
+                event = pending[i].event;
+                pending.erase(pending.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int attempts = 0;
+
+private:
+    size_t nextOutcome = 0;
+    std::vector<AttemptOutcome> pending; // afterMs holds the absolute due time
+};
+
+struct ActionRecord
+{
+    WiFiAction action;
+    unsigned long atMs;
+    WiFiState state;
+};
+
+struct Harness
+{
+    WiFiStateMachine machine;
+    MockRadio radio;
+    unsigned long nowMs = 0;
+    std::vector<ActionRecord> actions;
+
+    void apply(WiFiAction action)
+    {
+        if (action == WIFI_ACTION_NONE)
+            return;
+        actions.push_back({action, nowMs, machine.getState()});
+        if (action == WIFI_ACTION_BEGIN)
+            radio.begin(nowMs);
+    }
+
+    // Same call pattern as NetworkManager::update()
+    void runUntil(unsigned long endMs)
+    {
+        while (nowMs < endMs)
+        {
+            WiFiLinkEvent event;
+            while (radio.poll(nowMs, event))
+                apply(machine.handleEvent(event, nowMs));
+            apply(machine.update(nowMs));
+            nowMs += STEP_MS;
+        }
+    }
+
+    int count(WiFiAction action)
+    {
+        int n = 0;
+        for (const ActionRecord &record : actions)
+            n += record.action == action;
+        return n;
+    }
+
+    const ActionRecord *last(WiFiAction action)
+    {
+        for (size_t i = actions.size(); i > 0; i--)
+        {
+            if (actions[i - 1].action == action)
+                return &actions[i - 1];
+        }
+        return nullptr;
+    }
+};
+
+static int failures = 0;
+
+static void expect(bool condition, const char *scenario, const char *what)
+{
+    if (!condition)
+    {
+        printf("FAIL  %s: %s\n", scenario, what);
+        failures++;
+    }
+}
+
+static void checkBootConnects()
+{
+    const char *name = "boot with credentials";
+    Harness h;
+    h.radio.script = {JOIN};
+    h.apply(h.machine.start(true, 0));
+    expect(h.machine.getState() == WIFI_STATE_CONNECTING, name, "start() should be connecting");
+    h.runUntil(5000);
+    expect(h.machine.getState() == WIFI_STATE_CONNECTED, name, "should be connected");
+    expect(h.radio.attempts == 1, name, "should need one attempt");
+    expect(h.count(WIFI_ACTION_CONNECTED) == 1, name, "one CONNECTED action");
+}
+
+static void checkNoCredentials()
+{
+    const char *name = "no credentials";
+    Harness h;
+    h.apply(h.machine.start(false, 0));
+    expect(h.count(WIFI_ACTION_START_AP) == 1, name, "should start the AP at once");
+    h.runUntil(600000);
+    expect(h.radio.attempts == 0, name, "no station attempts without credentials");
+    expect(h.machine.getState() == WIFI_STATE_AP_FALLBACK, name, "AP stays up until setup");
+}
+
+static void checkBackoffThenAP()
+{
+    const char *name = "wrong password";
+    Harness h;
+    h.radio.script = {REJECT, REJECT, REJECT, REJECT, JOIN};
+    h.apply(h.machine.start(true, 0));
+    h.runUntil(20000);
+
+    // Attempt 1 fails at 3 s, retry after 1..2 s; attempt 2 fails, retry after 2..4 s
+    const ActionRecord &first = h.actions[1];
+    expect(first.action == WIFI_ACTION_FAILED && first.state == WIFI_STATE_BACKOFF, name, "first failure backs off");
+    expect(h.actions[2].action == WIFI_ACTION_BEGIN, name, "retry after the backoff");
+    unsigned long firstWait = h.actions[2].atMs - first.atMs;
+    expect(firstWait >= 1000 && firstWait <= 2100, name, "first backoff within 1-2 s");
+    unsigned long secondWait = h.actions[4].atMs - h.actions[3].atMs;
+    expect(secondWait >= 2000 && secondWait <= 4100, name, "second backoff within 2-4 s");
+
+    const ActionRecord *ap = h.last(WIFI_ACTION_START_AP);
+    expect(ap && h.radio.attempts == 3, name, "AP fallback after the third failure");
+    expect(h.machine.getState() == WIFI_STATE_AP_FALLBACK, name, "in AP fallback");
+
+    // Retries in AP mode keep at least a minute apart, then the network comes back
+    h.runUntil(ap->atMs + 59000);
+    expect(h.radio.attempts == 3, name, "no retry within a minute of the AP starting");
+    h.runUntil(400000);
+    expect(h.machine.getState() == WIFI_STATE_CONNECTED, name, "reconnects from AP fallback");
+    expect(h.machine.getFailures() == 0, name, "failure count resets on connect");
+}
+
+static void checkLinkLoss()
+{
+    const char *name = "link loss";
+    Harness h;
+    h.radio.script = {JOIN, REJECT, JOIN};
+    h.apply(h.machine.start(true, 0));
+    h.runUntil(10000);
+    h.radio.inject(10000, WIFI_LINK_DISCONNECTED);
+    h.runUntil(10200);
+    expect(h.count(WIFI_ACTION_LOST) == 1, name, "LOST action on disconnect");
+    expect(h.machine.getState() == WIFI_STATE_BACKOFF, name, "backs off after a drop");
+    h.runUntil(30000);
+    expect(h.machine.getState() == WIFI_STATE_CONNECTED, name, "reconnects");
+    expect(h.count(WIFI_ACTION_START_AP) == 0, name, "one failed retry is not enough for AP mode");
+}
+
+static void checkSilentTimeout()
+{
+    const char *name = "attempt timeout";
+    Harness h;
+    h.radio.script = {SILENT, JOIN};
+    h.apply(h.machine.start(true, 0));
+    h.runUntil(WiFiStateMachine::ATTEMPT_TIMEOUT_MS - STEP_MS);
+    expect(h.count(WIFI_ACTION_FAILED) == 0, name, "no failure before the timeout");
+    h.runUntil(WiFiStateMachine::ATTEMPT_TIMEOUT_MS + STEP_MS);
+    expect(h.count(WIFI_ACTION_FAILED) == 1, name, "failure at the timeout without any event");
+    h.runUntil(30000);
+    expect(h.machine.getState() == WIFI_STATE_CONNECTED, name, "next attempt connects");
+}
+
+static void checkStrayEvents()
+{
+    const char *name = "stray events";
+    Harness h;
+    h.radio.script = {REJECT, JOIN};
+    h.apply(h.machine.start(true, 0));
+    h.runUntil(3100); // First attempt rejected, now backing off
+    expect(h.machine.getState() == WIFI_STATE_BACKOFF, name, "backing off");
+    h.apply(h.machine.handleEvent(WIFI_LINK_DISCONNECTED, h.nowMs));
+    h.apply(h.machine.handleEvent(WIFI_LINK_GOT_IP, h.nowMs));
+    expect(h.machine.getState() == WIFI_STATE_BACKOFF && h.machine.getFailures() == 1, name,
+           "events outside an attempt are ignored");
+    h.runUntil(10000);
+    h.apply(h.machine.handleEvent(WIFI_LINK_GOT_IP, h.nowMs));
+    expect(h.count(WIFI_ACTION_CONNECTED) == 1, name, "duplicate GOT_IP is ignored");
+}
+
+static void checkJitter()
+{
+    const char *name = "backoff jitter";
+    unsigned long minDelay = NEVER, maxDelay = 0;
+    unsigned long capMin = NEVER, capMax = 0;
+    for (unsigned long seed = 1; seed <= 200; seed++)
+    {
+        randomSeed(seed);
+        Harness h;
+        h.radio.script = {REJECT};
+        h.apply(h.machine.start(true, 0));
+        h.runUntil(3100);
+        unsigned long delayMs = h.machine.getRetryDelay();
+        minDelay = delayMs < minDelay ? delayMs : minDelay;
+        maxDelay = delayMs > maxDelay ? delayMs : maxDelay;
+
+        // Long outage in AP fallback: the delay stops growing at the cap
+        h.runUntil(3600000);
+        delayMs = h.machine.getRetryDelay();
+        capMin = delayMs < capMin ? delayMs : capMin;
+        capMax = delayMs > capMax ? delayMs : capMax;
+    }
+    expect(minDelay >= 1000 && maxDelay <= 2000, name, "first delay within [1 s, 2 s]");
+    expect(maxDelay - minDelay >= 500, name, "first delay actually varies");
+    expect(capMin >= WiFiStateMachine::BACKOFF_MAX_MS / 2 && capMax <= WiFiStateMachine::BACKOFF_MAX_MS, name,
+           "capped delay within [max/2, max]");
+    printf("Backoff: first retry %lu-%lu ms, capped %lu-%lu ms over 200 seeds\n", minDelay, maxDelay, capMin, capMax);
+}
+
+int runWiFiCheck()
+{
+    failures = 0;
+    checkBootConnects();
+    checkNoCredentials();
+    checkBackoffThenAP();
+    checkLinkLoss();
+    checkSilentTimeout();
+    checkStrayEvents();
+    checkJitter();
+
+    printf(failures ? "WiFi check failed\n" : "WiFi check passed\n");
+    return failures ? 1 : 0;
+}
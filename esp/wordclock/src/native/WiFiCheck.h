@@ -0,0 +1,10 @@
+#ifndef WIFI_CHECK_H
+#define WIFI_CHECK_H
+
+// Drives WiFiStateMachine through scripted WiFi event sequences (a mock radio
+// on a virtual clock): boot, wrong password, AP fallback, link loss, silent
+// timeouts and stray events, plus the backoff jitter bounds. Prints one line
+// per failed expectation and returns non-zero if any failed.
+int runWiFiCheck();
+
+#endif
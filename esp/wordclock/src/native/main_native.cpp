@@ -0,0 +1,263 @@
+// Host entry point (env:native): runs WordClock, GifPlayer and NetworkManager on
+// Linux against the shims in native/shim, with frames going to SimOutput.
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <Preferences.h>
+#include <LittleFS.h>
+#include "ClockDisplayHAL.h"
+#include "DisplayCommand.h"
+#include "GifPlayer.h"
+#include "NetworkManager.h"
+#include "WordClock.h"
+#include "SimOutput.h"
+#include "TimeBenchmark.h"
+#include "GoldenCheck.h"
+#include "WiFiCheck.h"
+#include "NtpCheck.h"
+#include "TzCheck.h"
+#include "FlipMeasure.h"
+
+static void printUsage(const char *program)
+{
+    printf("Usage: %s [options]\n", program);
+    printf("  --output=terminal|ppm:<dir>|none  Where rendered frames go (default terminal)\n");
+    printf("  --ticks=N                         Run N one-second ticks, 0 = forever (default 0)\n");
+    printf("  --fast                            Do not sleep between ticks\n");
+    printf("  --ssid=NAME                       Store WiFi credentials so the clock starts connected\n");
+    printf("  --request=GET:/status             Send a request to the web server after setup\n");
+    printf("  --benchmark=day|year              Fast-forward a virtual clock and report render timings\n");
+    printf("  --check=golden                    Compare every minute and time zone with src/native/golden\n");
+    printf("  --check=wifi                      Run the WiFi state machine against a scripted mock radio\n");
+    printf("  --check=ntp                       Run the NTP client against fake servers on localhost\n");
+    printf("  --check=tz                        Compare the cached DST rules with localtime() for 20 years\n");
+    printf("  --ntp=HOST[:PORT],...             Store the NTP server list (e.g. --ntp=127.0.0.1 for a local ntpd)\n");
+    printf("  --measure=flips                   Log how far --ticks frame flips (default 10) land from the\n");
+    printf("                                    boundary, vs NTP time when --ntp is given\n");
+    printf("  --golden-dir=DIR                  Golden file directory (default src/native/golden)\n");
+    printf("  --update-golden                   Rewrite the golden files from the current output\n");
+    printf("  --tz=POSIX                        Time zone for --benchmark (default CET-1CEST,M3.5.0,M10.5.0/3)\n");
+    printf("  --gif=FILE                        Start with FILE as the animation stored on flash\n");
+}
+
+// Puts a host file into the simulated LittleFS
+static bool copyToFlash(const char *hostPath, const char *flashPath)
+{
+    FILE *in = fopen(hostPath, "rb");
+    if (!in)
+        return false;
+    File out = LittleFS.open(flashPath, FILE_WRITE);
+    uint8_t buffer[1024];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), in)) > 0)
+        out.write(buffer, length);
+    fclose(in);
+    out.close();
+    return true;
+}
+
+// Dispatch "METHOD:/path" to the web server NetworkManager started
+static void sendRequest(const char *spec)
+{
+    const char *path = strchr(spec, ':');
+    if (!path)
+    {
+        fprintf(stderr, "Bad request '%s', expected METHOD:/path\n", spec);
+        return;
+    }
+    WebRequestMethodComposite method = strncmp(spec, "POST", path - spec) == 0 ? HTTP_POST : HTTP_GET;
+
+    AsyncWebServer *server = AsyncWebServer::active();
+    if (!server)
+    {
+        fprintf(stderr, "No web server running\n");
+        return;
+    }
+
+    AsyncWebServerRequest request(method, String(path + 1));
+    server->handle(&request);
+    printf("%d %s\n%s\n", request.responseCode(), request.responseType().c_str(), request.responseBody().c_str());
+}
+
+// One network update, then every millisecond while NTP replies are outstanding,
+// like the network task on the device
+static void pollTimeSync(NetworkManager &networkManager)
+{
+    networkManager.update();
+    while (networkManager.isTimeSyncPolling())
+    {
+        delay(1);
+        networkManager.update();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    SimOutput::Mode mode = SimOutput::SIM_TERMINAL;
+    const char *ppmDirectory = ".";
+    const char *ssid = nullptr;
+    const char *ntpServers = nullptr;
+    const char *request = nullptr;
+    const char *benchmark = nullptr;
+    const char *check = nullptr;
+    const char *measure = nullptr;
+    const char *goldenDir = "src/native/golden";
+    bool updateGolden = false;
+    const char *tz = "CET-1CEST,M3.5.0,M10.5.0/3";
+    const char *gifFile = nullptr;
+    long ticks = 0;
+    bool fast = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--output=terminal") == 0)
+            mode = SimOutput::SIM_TERMINAL;
+        else if (strcmp(arg, "--output=none") == 0)
+            mode = SimOutput::SIM_MEMORY;
+        else if (strncmp(arg, "--output=ppm:", 13) == 0)
+        {
+            mode = SimOutput::SIM_PPM;
+            ppmDirectory = arg + 13;
+        }
+        else if (strncmp(arg, "--ticks=", 8) == 0)
+            ticks = atol(arg + 8);
+        else if (strcmp(arg, "--fast") == 0)
+            fast = true;
+        else if (strncmp(arg, "--ssid=", 7) == 0)
+            ssid = arg + 7;
+        else if (strncmp(arg, "--ntp=", 6) == 0)
+            ntpServers = arg + 6;
+        else if (strncmp(arg, "--request=", 10) == 0)
+            request = arg + 10;
+        else if (strncmp(arg, "--benchmark=", 12) == 0)
+            benchmark = arg + 12;
+        else if (strncmp(arg, "--check=", 8) == 0)
+            check = arg + 8;
+        else if (strncmp(arg, "--measure=", 10) == 0)
+            measure = arg + 10;
+        else if (strncmp(arg, "--golden-dir=", 13) == 0)
+            goldenDir = arg + 13;
+        else if (strcmp(arg, "--update-golden") == 0)
+            updateGolden = true;
+        else if (strncmp(arg, "--tz=", 5) == 0)
+            tz = arg + 5;
+        else if (strncmp(arg, "--gif=", 6) == 0)
+            gifFile = arg + 6;
+        else
+        {
+            printUsage(argv[0]);
+            return strcmp(arg, "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (check)
+    {
+        if (strcmp(check, "golden") == 0)
+            return runGoldenCheck(goldenDir, updateGolden);
+        if (strcmp(check, "wifi") == 0)
+            return runWiFiCheck();
+        if (strcmp(check, "ntp") == 0)
+            return runNtpCheck();
+        if (strcmp(check, "tz") == 0)
+            return runTzCheck();
+        fprintf(stderr, "Unknown check '%s'\n", check);
+        return 1;
+    }
+
+    if (measure)
+    {
+        if (strcmp(measure, "flips") != 0)
+        {
+            fprintf(stderr, "Unknown measurement '%s'\n", measure);
+            return 1;
+        }
+        return runFlipMeasure(ticks > 0 ? ticks : 10, ntpServers);
+    }
+
+    if (benchmark)
+    {
+        return runTimeBenchmark(benchmark, tz);
+    }
+
+    if (ssid)
+    {
+        Preferences preferences;
+        preferences.begin("wifi", false);
+        preferences.putString("ssid", ssid);
+        preferences.putString("password", "");
+        preferences.end();
+    }
+
+    if (ntpServers)
+    {
+        Preferences preferences;
+        preferences.begin("ntp", false);
+        preferences.putString("servers", ntpServers);
+        preferences.end();
+    }
+
+    SimOutput *output = new SimOutput(mode, ppmDirectory);
+    ClockDisplayHAL clockDisplayHAL(0, 255);
+    clockDisplayHAL.setOutput(output);
+    NetworkManager networkManager(3600, 3600);
+    DisplayCommandQueue displayCommands;
+    networkManager.setDisplayCommandQueue(&displayCommands);
+    GifPlayer gifPlayer(&clockDisplayHAL);
+    WordClock wordClock(&clockDisplayHAL, &gifPlayer);
+
+    clockDisplayHAL.setup();
+    LittleFS.begin(true);
+    if (gifFile && !copyToFlash(gifFile, AnimationStore::PATH))
+    {
+        fprintf(stderr, "Cannot read %s\n", gifFile);
+        return 1;
+    }
+    networkManager.setup();
+    networkManager.getAnimationStore().begin();
+    if (networkManager.getAnimationStore().hasAnimation())
+    {
+        wordClock.loadGIF(); // Like a reboot with an animation already on flash
+    }
+    wordClock.setTimeZone(networkManager.getTimezone());
+    networkManager.update(); // Picks up the fake radio's instant connect
+    pollTimeSync(networkManager); // So --request=GET:/status sees the first NTP results
+
+    if (request)
+    {
+        sendRequest(request);
+        DisplayCommand command;
+        while (displayCommands.pop(command))
+        {
+            printf("Display command queued: %d\n", command);
+        }
+    }
+
+    for (long tick = 0; ticks == 0 || tick < ticks; tick++)
+    {
+        pollTimeSync(networkManager);
+        if (networkManager.isConnected())
+        {
+            // Same revalidation policy as gifTask in main.cpp
+            AnimationStore &store = networkManager.getAnimationStore();
+            if (store.isDue() && store.fetch(WordClock::GIF_URL) == AnimationStore::UPDATED)
+            {
+                wordClock.loadGIF();
+            }
+            wordClock.displayTime();
+            while (gifPlayer.isPlaying())
+            {
+                delay(gifPlayer.tick()); // Hourly animation, then the clock face again
+                if (!gifPlayer.isPlaying())
+                    wordClock.displayTime();
+            }
+        }
+        if (!fast)
+        {
+            delay(1000);
+        }
+    }
+
+    fprintf(stderr, "%u frame(s) pushed to the LEDs\n", output->getFrameCount());
+    return 0;
+}
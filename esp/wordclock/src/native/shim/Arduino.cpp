@@ -0,0 +1,316 @@
+#include "Arduino.h"
+#include <stdarg.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static std::string formatInteger(unsigned long long value, bool negative, unsigned char base)
+{
+    if (base < 2 || base > 36)
+    {
+        base = 10;
+    }
+    std::string digits;
+    do
+    {
+        int digit = value % base;
+        digits += (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    } while (value);
+    if (negative)
+    {
+        digits += '-';
+    }
+    std::reverse(digits.begin(), digits.end());
+    return digits;
+}
+
+static std::string formatSigned(long long value, unsigned char base)
+{
+    if (value < 0 && base == 10)
+    {
+        return formatInteger(0ULL - (unsigned long long)value, true, base);
+    }
+    return formatInteger((unsigned long long)value, false, base);
+}
+
+static std::string formatFloat(double value, unsigned char decimalPlaces)
+{
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", decimalPlaces, value);
+    return text;
+}
+
+String::String(const char *cstr) : buffer(cstr ? cstr : "") {}
+String::String(const std::string &str) : buffer(str) {}
+String::String(char c) : buffer(1, c) {}
+String::String(unsigned char value, unsigned char base) : buffer(formatInteger(value, false, base)) {}
+String::String(int value, unsigned char base) : buffer(formatSigned(value, base)) {}
+String::String(unsigned int value, unsigned char base) : buffer(formatInteger(value, false, base)) {}
+String::String(long value, unsigned char base) : buffer(formatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base) : buffer(formatInteger(value, false, base)) {}
+String::String(long long value, unsigned char base) : buffer(formatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : buffer(formatInteger(value, false, base)) {}
+String::String(float value, unsigned char decimalPlaces) : buffer(formatFloat(value, decimalPlaces)) {}
+String::String(double value, unsigned char decimalPlaces) : buffer(formatFloat(value, decimalPlaces)) {}
+
+String &String::operator+=(const String &rhs)
+{
+    buffer += rhs.buffer;
+    return *this;
+}
+
+String &String::operator+=(const char *rhs)
+{
+    if (rhs)
+    {
+        buffer += rhs;
+    }
+    return *this;
+}
+
+String &String::operator+=(char rhs)
+{
+    buffer += rhs;
+    return *this;
+}
+
+bool String::concat(const String &rhs)
+{
+    *this += rhs;
+    return true;
+}
+
+bool String::concat(const char *rhs)
+{
+    *this += rhs;
+    return true;
+}
+
+bool String::equalsIgnoreCase(const String &rhs) const
+{
+    return strcasecmp(buffer.c_str(), rhs.buffer.c_str()) == 0;
+}
+
+bool String::startsWith(const String &prefix) const
+{
+    return buffer.compare(0, prefix.buffer.length(), prefix.buffer) == 0;
+}
+
+bool String::endsWith(const String &suffix) const
+{
+    return buffer.length() >= suffix.buffer.length() &&
+           buffer.compare(buffer.length() - suffix.buffer.length(), suffix.buffer.length(), suffix.buffer) == 0;
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const
+{
+    size_t found = buffer.find(ch, fromIndex);
+    return found == std::string::npos ? -1 : (int)found;
+}
+
+int String::indexOf(const String &str, unsigned int fromIndex) const
+{
+    size_t found = buffer.find(str.buffer, fromIndex);
+    return found == std::string::npos ? -1 : (int)found;
+}
+
+int String::lastIndexOf(char ch) const
+{
+    size_t found = buffer.rfind(ch);
+    return found == std::string::npos ? -1 : (int)found;
+}
+
+String String::substring(unsigned int beginIndex) const
+{
+    return substring(beginIndex, buffer.length());
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const
+{
+    if (beginIndex > endIndex)
+    {
+        std::swap(beginIndex, endIndex);
+    }
+    if (beginIndex >= buffer.length())
+    {
+        return String();
+    }
+    return String(buffer.substr(beginIndex, endIndex - beginIndex));
+}
+
+void String::replace(const String &find, const String &replacement)
+{
+    if (find.buffer.empty())
+    {
+        return;
+    }
+    size_t pos = 0;
+    while ((pos = buffer.find(find.buffer, pos)) != std::string::npos)
+    {
+        buffer.replace(pos, find.buffer.length(), replacement.buffer);
+        pos += replacement.buffer.length();
+    }
+}
+
+void String::trim()
+{
+    size_t begin = buffer.find_first_not_of(" \t\r\n");
+    size_t end = buffer.find_last_not_of(" \t\r\n");
+    buffer = begin == std::string::npos ? "" : buffer.substr(begin, end - begin + 1);
+}
+
+void String::toLowerCase()
+{
+    std::transform(buffer.begin(), buffer.end(), buffer.begin(), ::tolower);
+}
+
+void String::toUpperCase()
+{
+    std::transform(buffer.begin(), buffer.end(), buffer.begin(), ::toupper);
+}
+
+String operator+(const String &lhs, const String &rhs)
+{
+    String result(lhs);
+    result += rhs;
+    return result;
+}
+
+IPAddress::IPAddress() : octets{0, 0, 0, 0} {}
+
+IPAddress::IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets{a, b, c, d} {}
+
+IPAddress::IPAddress(uint32_t address)
+{
+    memcpy(octets, &address, sizeof(octets));
+}
+
+IPAddress::operator uint32_t() const
+{
+    uint32_t address;
+    memcpy(&address, octets, sizeof(address));
+    return address;
+}
+
+bool IPAddress::operator==(const IPAddress &rhs) const
+{
+    return memcmp(octets, rhs.octets, sizeof(octets)) == 0;
+}
+
+String IPAddress::toString() const
+{
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+    return String(text);
+}
+
+bool IPAddress::fromString(const char *address)
+{
+    unsigned int a, b, c, d;
+    if (sscanf(address, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255)
+    {
+        return false;
+    }
+    *this = IPAddress(a, b, c, d);
+    return true;
+}
+
+// Serial goes to stderr so stdout stays free for rendered frames
+void HardwareSerial::begin(unsigned long) {}
+size_t HardwareSerial::print(const char *str) { return fputs(str, stderr) < 0 ? 0 : strlen(str); }
+size_t HardwareSerial::print(const String &str) { return print(str.c_str()); }
+size_t HardwareSerial::print(char c) { return fputc(c, stderr) == EOF ? 0 : 1; }
+size_t HardwareSerial::print(int value, int base) { return print(String(value, (unsigned char)base)); }
+size_t HardwareSerial::print(unsigned int value, int base) { return print(String(value, (unsigned char)base)); }
+size_t HardwareSerial::print(long value, int base) { return print(String(value, (unsigned char)base)); }
+size_t HardwareSerial::print(unsigned long value, int base) { return print(String(value, (unsigned char)base)); }
+size_t HardwareSerial::print(double value, int digits) { return print(String(value, (unsigned char)digits)); }
+size_t HardwareSerial::println() { return print("\n"); }
+
+int HardwareSerial::printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int written = vfprintf(stderr, format, args);
+    va_end(args);
+    return written;
+}
+
+void EspClass::restart()
+{
+    fprintf(stderr, "ESP.restart() called, exiting\n");
+    exit(0);
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+    return 320 * 1024;
+}
+
+static const std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+
+unsigned long millis()
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - bootTime)
+        .count();
+}
+
+unsigned long micros()
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - bootTime)
+        .count();
+}
+
+void delay(unsigned long ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {}
+
+long random(long howBig)
+{
+    return howBig > 0 ? rand() % howBig : 0;
+}
+
+long random(long howSmall, long howBig)
+{
+    return howSmall >= howBig ? howSmall : howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long seed)
+{
+    srand((unsigned int)seed);
+}
+
+// No buttons on the host: inputs read as released (pull-up high)
+void pinMode(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return HIGH; }
+void digitalWrite(uint8_t, uint8_t) {}
+
+bool getLocalTime(struct tm *info, uint32_t)
+{
+    time_t now = time(nullptr);
+    localtime_r(&now, info);
+    return info->tm_year > (2016 - 1900);
+}
+
+// The host clock is already NTP-disciplined; configTzTime() lives in esp_sntp.cpp
+void configTime(long, int, const char *, const char *, const char *) {}
+
+void configTzTime(const char *tz, const char *, const char *, const char *)
+{
+    setenv("TZ", tz, 1);
+    tzset();
+}
@@ -0,0 +1,188 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Minimal Arduino core for host builds (env:native).
+// Only covers what the clock sources use; the host is treated as single-threaded.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <string>
+#include <atomic>
+
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define DEC 10
+#define HEX 16
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+class String
+{
+public:
+    String(const char *cstr = "");
+    String(const std::string &str);
+    explicit String(char c);
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(long long value, unsigned char base = 10);
+    explicit String(unsigned long long value, unsigned char base = 10);
+    explicit String(float value, unsigned char decimalPlaces = 2);
+    explicit String(double value, unsigned char decimalPlaces = 2);
+
+    const char *c_str() const { return buffer.c_str(); }
+    unsigned int length() const { return buffer.length(); }
+    bool isEmpty() const { return buffer.empty(); }
+    void reserve(unsigned int size) { buffer.reserve(size); }
+
+    String &operator+=(const String &rhs);
+    String &operator+=(const char *rhs);
+    String &operator+=(char rhs);
+    bool concat(const String &rhs);
+    bool concat(const char *rhs);
+
+    bool equals(const String &rhs) const { return buffer == rhs.buffer; }
+    bool equals(const char *rhs) const { return buffer == (rhs ? rhs : ""); }
+    bool equalsIgnoreCase(const String &rhs) const;
+    bool operator==(const String &rhs) const { return equals(rhs); }
+    bool operator==(const char *rhs) const { return equals(rhs); }
+    bool operator!=(const String &rhs) const { return !equals(rhs); }
+    bool operator!=(const char *rhs) const { return !equals(rhs); }
+    bool operator<(const String &rhs) const { return buffer < rhs.buffer; }
+    bool startsWith(const String &prefix) const;
+    bool endsWith(const String &suffix) const;
+
+    char charAt(unsigned int index) const { return index < buffer.length() ? buffer[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    int indexOf(char ch, unsigned int fromIndex = 0) const;
+    int indexOf(const String &str, unsigned int fromIndex = 0) const;
+    int lastIndexOf(char ch) const;
+    String substring(unsigned int beginIndex) const;
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    void replace(const String &find, const String &replacement);
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+    long toInt() const { return strtol(buffer.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(buffer.c_str(), nullptr); }
+
+private:
+    std::string buffer;
+};
+
+String operator+(const String &lhs, const String &rhs);
+
+class IPAddress
+{
+public:
+    IPAddress();
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d);
+    explicit IPAddress(uint32_t address);
+    operator uint32_t() const;
+    uint8_t operator[](int index) const { return octets[index]; }
+    bool operator==(const IPAddress &rhs) const;
+    String toString() const;
+    bool fromString(const char *address);
+
+private:
+    uint8_t octets[4];
+};
+
+class HardwareSerial
+{
+public:
+    void begin(unsigned long baud);
+    size_t print(const char *str);
+    size_t print(const String &str);
+    size_t print(char c);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+    size_t println();
+    template <typename T>
+    size_t println(T value)
+    {
+        size_t n = print(value);
+        return n + println();
+    }
+    int printf(const char *format, ...);
+};
+
+// Byte stream as far as the sources use it (HTTPClient::writeToStream into a fs::File)
+class Stream
+{
+public:
+    virtual ~Stream() {}
+    virtual size_t write(const uint8_t *buffer, size_t size) = 0;
+    virtual int available() = 0;
+    virtual int read() = 0;
+};
+
+class EspClass
+{
+public:
+    void restart();
+    uint32_t getFreeHeap();
+};
+
+extern HardwareSerial Serial;
+extern EspClass ESP;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+// esp32-hal-time
+bool getLocalTime(struct tm *info, uint32_t ms = 5000);
+void configTime(long gmtOffset_sec, int daylightOffset_sec, const char *server1,
+                const char *server2 = nullptr, const char *server3 = nullptr);
+void configTzTime(const char *tz, const char *server1, const char *server2 = nullptr, const char *server3 = nullptr);
+
+// FreeRTOS spinlocks: real ones, the lwIP shim answers DNS lookups from its own thread
+struct portMUX_TYPE
+{
+    std::atomic<bool> locked;
+    portMUX_TYPE(int = 0) : locked(false) {}
+};
+#define portMUX_INITIALIZER_UNLOCKED 0
+
+inline void portENTER_CRITICAL(portMUX_TYPE *mux)
+{
+    while (mux->locked.exchange(true, std::memory_order_acquire))
+    {
+    }
+}
+
+inline void portEXIT_CRITICAL(portMUX_TYPE *mux)
+{
+    mux->locked.store(false, std::memory_order_release);
+}
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef NATIVE_DNSSERVER_H
+#define NATIVE_DNSSERVER_H
+
+#include <Arduino.h>
+
+// Captive-portal DNS is not emulated on the host
+class DNSServer
+{
+public:
+    bool start(uint16_t, const String &, const IPAddress &) { return true; }
+    void stop() {}
+    void processNextRequest() {}
+};
+
+#endif
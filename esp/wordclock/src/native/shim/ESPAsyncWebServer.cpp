@@ -0,0 +1,97 @@
+#include "ESPAsyncWebServer.h"
+
+static AsyncWebServer *activeServer = nullptr;
+
+AsyncWebServerRequest::AsyncWebServerRequest(WebRequestMethodComposite method, const String &url)
+    : requestMethod(method), requestUrl(url), code(0)
+{
+}
+
+void AsyncWebServerRequest::addParam(const String &name, const String &value, bool post)
+{
+    params.push_back(AsyncWebParameter(name, value, post));
+}
+
+bool AsyncWebServerRequest::hasParam(const String &name, bool post, bool) const
+{
+    for (const AsyncWebParameter &param : params)
+    {
+        if (param.name() == name && param.isPost() == post)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+AsyncWebParameter *AsyncWebServerRequest::getParam(const String &name, bool post, bool)
+{
+    for (AsyncWebParameter &param : params)
+    {
+        if (param.name() == name && param.isPost() == post)
+        {
+            return &param;
+        }
+    }
+    return nullptr;
+}
+
+void AsyncWebServerRequest::send(int responseCode, const String &type, const String &body)
+{
+    code = responseCode;
+    contentType = type;
+    content = body;
+}
+
+AsyncWebServer::AsyncWebServer(uint16_t port) : port(port) {}
+
+AsyncWebServer::~AsyncWebServer()
+{
+    end();
+}
+
+void AsyncWebServer::begin()
+{
+    activeServer = this;
+}
+
+void AsyncWebServer::end()
+{
+    if (activeServer == this)
+    {
+        activeServer = nullptr;
+    }
+}
+
+void AsyncWebServer::on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest)
+{
+    routes.push_back(Route{String(uri), method, onRequest});
+}
+
+void AsyncWebServer::onNotFound(ArRequestHandlerFunction fn)
+{
+    notFoundHandler = fn;
+}
+
+bool AsyncWebServer::handle(AsyncWebServerRequest *request)
+{
+    for (const Route &route : routes)
+    {
+        if (route.uri == request->url() && (route.method & request->method()))
+        {
+            route.handler(request);
+            return true;
+        }
+    }
+    if (notFoundHandler)
+    {
+        notFoundHandler(request);
+        return true;
+    }
+    return false;
+}
+
+AsyncWebServer *AsyncWebServer::active()
+{
+    return activeServer;
+}
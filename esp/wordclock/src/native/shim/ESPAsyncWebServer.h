@@ -0,0 +1,100 @@
+#ifndef NATIVE_ESPASYNCWEBSERVER_H
+#define NATIVE_ESPASYNCWEBSERVER_H
+
+// Host stand-in for ESPAsyncWebServer. Nothing listens on a socket; instead the
+// routes are kept so the simulator can dispatch requests to the real handlers.
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+typedef enum
+{
+    HTTP_GET = 0b00000001,
+    HTTP_POST = 0b00000010,
+    HTTP_DELETE = 0b00000100,
+    HTTP_PUT = 0b00001000,
+    HTTP_PATCH = 0b00010000,
+    HTTP_HEAD = 0b00100000,
+    HTTP_OPTIONS = 0b01000000,
+    HTTP_ANY = 0b01111111
+} WebRequestMethod;
+
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebParameter
+{
+public:
+    AsyncWebParameter(const String &name, const String &value, bool form)
+        : paramName(name), paramValue(value), form(form) {}
+    const String &name() const { return paramName; }
+    const String &value() const { return paramValue; }
+    bool isPost() const { return form; }
+
+private:
+    String paramName;
+    String paramValue;
+    bool form;
+};
+
+class AsyncWebServerRequest
+{
+public:
+    AsyncWebServerRequest(WebRequestMethodComposite method, const String &url);
+
+    WebRequestMethodComposite method() const { return requestMethod; }
+    const String &url() const { return requestUrl; }
+
+    void addParam(const String &name, const String &value, bool post = false);
+    bool hasParam(const String &name, bool post = false, bool file = false) const;
+    AsyncWebParameter *getParam(const String &name, bool post = false, bool file = false);
+
+    void send(int code, const String &contentType = String(), const String &content = String());
+
+    // Captured response, for inspection on the host
+    int responseCode() const { return code; }
+    const String &responseType() const { return contentType; }
+    const String &responseBody() const { return content; }
+
+private:
+    WebRequestMethodComposite requestMethod;
+    String requestUrl;
+    std::vector<AsyncWebParameter> params;
+    int code;
+    String contentType;
+    String content;
+};
+
+typedef std::function<void(AsyncWebServerRequest *request)> ArRequestHandlerFunction;
+
+class AsyncWebServer
+{
+public:
+    AsyncWebServer(uint16_t port);
+    ~AsyncWebServer();
+
+    void begin();
+    void end();
+    void on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest);
+    void onNotFound(ArRequestHandlerFunction fn);
+
+    // Route a request the way the real server would; false if nothing handled it
+    bool handle(AsyncWebServerRequest *request);
+
+    // Most recently started server, or nullptr
+    static AsyncWebServer *active();
+
+private:
+    struct Route
+    {
+        String uri;
+        WebRequestMethodComposite method;
+        ArRequestHandlerFunction handler;
+    };
+
+    uint16_t port;
+    std::vector<Route> routes;
+    ArRequestHandlerFunction notFoundHandler;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "FS.h"
+#include "LittleFS.h"
+#include <map>
+
+static std::map<std::string, std::shared_ptr<std::string>> &files()
+{
+    static std::map<std::string, std::shared_ptr<std::string>> entries;
+    return entries;
+}
+
+namespace fs
+{
+
+size_t File::write(const uint8_t *buffer, size_t size)
+{
+    if (!data || !writable)
+    {
+        return 0;
+    }
+    if (data->size() < pos + size)
+    {
+        data->resize(pos + size);
+    }
+    memcpy(&(*data)[pos], buffer, size);
+    pos += size;
+    return size;
+}
+
+int File::available()
+{
+    return data && pos < data->size() ? (int)(data->size() - pos) : 0;
+}
+
+int File::read()
+{
+    uint8_t byte;
+    return read(&byte, 1) == 1 ? byte : -1;
+}
+
+size_t File::read(uint8_t *buffer, size_t size)
+{
+    size_t count = (size_t)available() < size ? (size_t)available() : size;
+    if (count > 0)
+    {
+        memcpy(buffer, data->data() + pos, count);
+        pos += count;
+    }
+    return count;
+}
+
+bool File::seek(uint32_t offset, SeekMode mode)
+{
+    if (!data)
+    {
+        return false;
+    }
+    size_t base = mode == SeekSet ? 0 : mode == SeekCur ? pos : data->size();
+    if (base + offset > data->size())
+    {
+        return false;
+    }
+    pos = base + offset;
+    return true;
+}
+
+File FS::open(const char *path, const char *mode, bool)
+{
+    auto entry = files().find(path);
+    if (mode[0] == 'r')
+    {
+        return entry == files().end() ? File() : File(path, entry->second, false);
+    }
+    if (entry == files().end() || mode[0] == 'w')
+    {
+        // Writers of an existing file get a fresh copy; open readers keep theirs
+        files()[path] = std::make_shared<std::string>(mode[0] == 'a' && entry != files().end() ? *entry->second : "");
+    }
+    File file(path, files()[path], true);
+    file.seek(0, mode[0] == 'a' ? SeekEnd : SeekSet);
+    return file;
+}
+
+bool FS::exists(const char *path)
+{
+    return files().count(path) > 0;
+}
+
+bool FS::remove(const char *path)
+{
+    return files().erase(path) > 0;
+}
+
+bool FS::rename(const char *from, const char *to)
+{
+    auto entry = files().find(from);
+    if (entry == files().end())
+    {
+        return false;
+    }
+    auto data = entry->second;
+    files().erase(entry);
+    files()[to] = data;
+    return true;
+}
+
+bool LittleFSFS::begin(bool, const char *, uint8_t, const char *)
+{
+    return true;
+}
+
+bool LittleFSFS::format()
+{
+    files().clear();
+    return true;
+}
+
+size_t LittleFSFS::usedBytes()
+{
+    size_t used = 0;
+    for (auto &entry : files())
+    {
+        used += entry.second->size();
+    }
+    return used;
+}
+
+} // namespace fs
+
+fs::LittleFSFS LittleFS;
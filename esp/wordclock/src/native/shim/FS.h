@@ -0,0 +1,68 @@
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+// Host stand-in for the Arduino fs layer: files live in memory for the run,
+// like the Preferences shim.
+
+#include <Arduino.h>
+#include <memory>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs
+{
+
+enum SeekMode
+{
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+class File : public Stream
+{
+public:
+    File() : pos(0), writable(false) {}
+    File(const std::string &path, std::shared_ptr<std::string> data, bool writable)
+        : path(path), data(data), pos(0), writable(writable) {}
+
+    size_t write(const uint8_t *buffer, size_t size) override;
+    size_t write(uint8_t byte) { return write(&byte, 1); }
+    int available() override;
+    int read() override;
+    size_t read(uint8_t *buffer, size_t size);
+    bool seek(uint32_t offset, SeekMode mode = SeekSet);
+    size_t position() const { return pos; }
+    size_t size() const { return data ? data->size() : 0; }
+    const char *name() const { return path.c_str(); }
+    void close() { data.reset(); }
+    operator bool() const { return data != nullptr; }
+
+private:
+    std::string path;
+    std::shared_ptr<std::string> data;
+    size_t pos;
+    bool writable;
+};
+
+class FS
+{
+public:
+    File open(const char *path, const char *mode = FILE_READ, bool create = false);
+    File open(const String &path, const char *mode = FILE_READ) { return open(path.c_str(), mode); }
+    bool exists(const char *path);
+    bool exists(const String &path) { return exists(path.c_str()); }
+    bool remove(const char *path);
+    bool remove(const String &path) { return remove(path.c_str()); }
+    bool rename(const char *from, const char *to);
+    bool rename(const String &from, const String &to) { return rename(from.c_str(), to.c_str()); }
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
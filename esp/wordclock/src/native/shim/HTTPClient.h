@@ -0,0 +1,43 @@
+#ifndef NATIVE_HTTPCLIENT_H
+#define NATIVE_HTTPCLIENT_H
+
+// Host stand-in for HTTPClient: every request fails to connect, as if offline.
+
+#include <Arduino.h>
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_NOT_MODIFIED 304
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+
+class WiFiClient
+{
+public:
+    int available() { return 0; }
+    int read() { return -1; }
+    bool connected() { return false; }
+};
+
+class HTTPClient
+{
+public:
+    bool begin(const String &url)
+    {
+        this->url = url;
+        return true;
+    }
+    void addHeader(const String &, const String &) {}
+    void collectHeaders(const char *[], size_t) {}
+    String header(const char *) { return String(); }
+    int GET() { return HTTPC_ERROR_CONNECTION_REFUSED; }
+    int getSize() { return -1; }
+    WiFiClient *getStreamPtr() { return &client; }
+    int writeToStream(Stream *) { return HTTPC_ERROR_CONNECTION_REFUSED; }
+    bool connected() { return false; }
+    void end() {}
+
+private:
+    String url;
+    WiFiClient client;
+};
+
+#endif
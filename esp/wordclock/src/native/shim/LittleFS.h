@@ -0,0 +1,26 @@
+#ifndef NATIVE_LITTLEFS_H
+#define NATIVE_LITTLEFS_H
+
+#include "FS.h"
+
+namespace fs
+{
+
+class LittleFSFS : public FS
+{
+public:
+    static const size_t TOTAL_BYTES = 1408 * 1024; // Default partition table's data partition
+
+    bool begin(bool formatOnFail = false, const char *basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char *partitionLabel = "spiffs");
+    bool format();
+    size_t totalBytes() { return TOTAL_BYTES; }
+    size_t usedBytes();
+    void end() {}
+};
+
+} // namespace fs
+
+extern fs::LittleFSFS LittleFS;
+
+#endif
@@ -0,0 +1,144 @@
+#include "Preferences.h"
+#include <map>
+
+typedef std::map<std::string, std::string> Namespace;
+
+static std::map<std::string, Namespace> &storage()
+{
+    static std::map<std::string, Namespace> namespaces;
+    return namespaces;
+}
+
+Preferences::Preferences() : opened(false), readOnly(false) {}
+
+bool Preferences::begin(const char *newName, bool newReadOnly, const char *)
+{
+    name = newName;
+    readOnly = newReadOnly;
+    opened = true;
+    return true;
+}
+
+void Preferences::end()
+{
+    opened = false;
+}
+
+bool Preferences::clear()
+{
+    if (!opened || readOnly)
+    {
+        return false;
+    }
+    storage()[name].clear();
+    return true;
+}
+
+bool Preferences::remove(const char *key)
+{
+    if (!opened || readOnly)
+    {
+        return false;
+    }
+    return storage()[name].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char *key)
+{
+    return find(key) != nullptr;
+}
+
+bool Preferences::put(const char *key, const void *value, size_t length)
+{
+    if (!opened || readOnly)
+    {
+        return false;
+    }
+    storage()[name][key] = std::string((const char *)value, length);
+    return true;
+}
+
+const std::string *Preferences::find(const char *key)
+{
+    if (!opened)
+    {
+        return nullptr;
+    }
+    Namespace &values = storage()[name];
+    Namespace::const_iterator it = values.find(key);
+    return it == values.end() ? nullptr : &it->second;
+}
+
+size_t Preferences::putString(const char *key, const char *value)
+{
+    return put(key, value, strlen(value)) ? strlen(value) : 0;
+}
+
+size_t Preferences::putString(const char *key, String value)
+{
+    return putString(key, value.c_str());
+}
+
+String Preferences::getString(const char *key, String defaultValue)
+{
+    const std::string *value = find(key);
+    return value ? String(*value) : defaultValue;
+}
+
+size_t Preferences::putLong(const char *key, int32_t value)
+{
+    return put(key, &value, sizeof(value)) ? sizeof(value) : 0;
+}
+
+int32_t Preferences::getLong(const char *key, int32_t defaultValue)
+{
+    int32_t value = defaultValue;
+    getBytes(key, &value, sizeof(value));
+    return value;
+}
+
+size_t Preferences::putULong(const char *key, uint32_t value)
+{
+    return put(key, &value, sizeof(value)) ? sizeof(value) : 0;
+}
+
+uint32_t Preferences::getULong(const char *key, uint32_t defaultValue)
+{
+    uint32_t value = defaultValue;
+    getBytes(key, &value, sizeof(value));
+    return value;
+}
+
+size_t Preferences::putUChar(const char *key, uint8_t value)
+{
+    return put(key, &value, sizeof(value)) ? sizeof(value) : 0;
+}
+
+uint8_t Preferences::getUChar(const char *key, uint8_t defaultValue)
+{
+    uint8_t value = defaultValue;
+    getBytes(key, &value, sizeof(value));
+    return value;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t length)
+{
+    return put(key, value, length) ? length : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buffer, size_t maxLength)
+{
+    const std::string *value = find(key);
+    if (!value || value->size() > maxLength)
+    {
+        return 0;
+    }
+    memcpy(buffer, value->data(), value->size());
+    return value->size();
+}
+
+size_t Preferences::getBytesLength(const char *key)
+{
+    const std::string *value = find(key);
+    return value ? value->size() : 0;
+}
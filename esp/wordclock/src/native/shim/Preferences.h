@@ -0,0 +1,43 @@
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+// Host stand-in for the ESP32 NVS Preferences library, backed by memory.
+// Contents live for the lifetime of the process, shared by all instances.
+
+#include <Arduino.h>
+
+class Preferences
+{
+public:
+    Preferences();
+    bool begin(const char *name, bool readOnly = false, const char *partitionLabel = nullptr);
+    void end();
+
+    bool clear();
+    bool remove(const char *key);
+    bool isKey(const char *key);
+
+    size_t putString(const char *key, const char *value);
+    size_t putString(const char *key, String value);
+    String getString(const char *key, String defaultValue = String());
+
+    size_t putLong(const char *key, int32_t value);
+    int32_t getLong(const char *key, int32_t defaultValue = 0);
+    size_t putULong(const char *key, uint32_t value);
+    uint32_t getULong(const char *key, uint32_t defaultValue = 0);
+    size_t putUChar(const char *key, uint8_t value);
+    uint8_t getUChar(const char *key, uint8_t defaultValue = 0);
+    size_t putBytes(const char *key, const void *value, size_t length);
+    size_t getBytes(const char *key, void *buffer, size_t maxLength);
+    size_t getBytesLength(const char *key);
+
+private:
+    std::string name;
+    bool opened;
+    bool readOnly;
+
+    bool put(const char *key, const void *value, size_t length);
+    const std::string *find(const char *key);
+};
+
+#endif
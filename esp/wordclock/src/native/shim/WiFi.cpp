@@ -0,0 +1,216 @@
+#include "WiFi.h"
+#include <netdb.h>
+#include <netinet/in.h>
+
+WiFiClass WiFi;
+
+struct SimulatedNetwork
+{
+    const char *ssid;
+    int32_t rssi;
+    wifi_auth_mode_t encryption;
+};
+
+static const SimulatedNetwork SIMULATED_NETWORKS[] = {
+    {"SimNet", -48, WIFI_AUTH_WPA2_PSK},
+    {"SimNet-Guest", -63, WIFI_AUTH_OPEN},
+    {"Neighbour", -81, WIFI_AUTH_WPA2_PSK}};
+static const int16_t NUM_SIMULATED_NETWORKS = sizeof(SIMULATED_NETWORKS) / sizeof(SIMULATED_NETWORKS[0]);
+
+WiFiClass::WiFiClass()
+    : currentMode(WIFI_OFF), currentStatus(WL_DISCONNECTED), failConnect(false), scanState(WIFI_SCAN_FAILED),
+      eventCallbackCount(0)
+{
+}
+
+bool WiFiClass::mode(wifi_mode_t newMode)
+{
+    currentMode = newMode;
+    if (newMode == WIFI_OFF)
+    {
+        currentStatus = WL_DISCONNECTED;
+    }
+    return true;
+}
+
+wifi_mode_t WiFiClass::getMode()
+{
+    return currentMode;
+}
+
+bool WiFiClass::setAutoReconnect(bool)
+{
+    return true;
+}
+
+int WiFiClass::onEvent(WiFiEventCb callback)
+{
+    if (eventCallbackCount >= MAX_EVENT_CALLBACKS)
+    {
+        return -1;
+    }
+    eventCallbacks[eventCallbackCount] = callback;
+    return eventCallbackCount++;
+}
+
+void WiFiClass::fireEvent(arduino_event_id_t event)
+{
+    for (int i = 0; i < eventCallbackCount; i++)
+    {
+        eventCallbacks[i](event);
+    }
+}
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *, int32_t, const uint8_t *, bool connect)
+{
+    if (!connect)
+    {
+        return currentStatus;
+    }
+    connectedSSID = ssid;
+    currentStatus = (failConnect || !ssid || !*ssid) ? WL_CONNECT_FAILED : WL_CONNECTED;
+    fireEvent(currentStatus == WL_CONNECTED ? ARDUINO_EVENT_WIFI_STA_GOT_IP : ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    return currentStatus;
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool)
+{
+    if (currentStatus == WL_CONNECTED)
+    {
+        fireEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    }
+    currentStatus = WL_DISCONNECTED;
+    if (wifioff)
+    {
+        currentMode = WIFI_OFF;
+    }
+    return true;
+}
+
+wl_status_t WiFiClass::status()
+{
+    return currentStatus;
+}
+
+String WiFiClass::SSID()
+{
+    return currentStatus == WL_CONNECTED ? connectedSSID : String();
+}
+
+int32_t WiFiClass::RSSI()
+{
+    return currentStatus == WL_CONNECTED ? -48 : 0;
+}
+
+IPAddress WiFiClass::localIP()
+{
+    return currentStatus == WL_CONNECTED ? IPAddress(127, 0, 0, 1) : IPAddress();
+}
+
+IPAddress WiFiClass::gatewayIP()
+{
+    return currentStatus == WL_CONNECTED ? IPAddress(127, 0, 0, 1) : IPAddress();
+}
+
+IPAddress WiFiClass::subnetMask()
+{
+    return currentStatus == WL_CONNECTED ? IPAddress(255, 0, 0, 0) : IPAddress();
+}
+
+IPAddress WiFiClass::dnsIP(uint8_t)
+{
+    return gatewayIP();
+}
+
+int WiFiClass::hostByName(const char *hostname, IPAddress &result)
+{
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    struct addrinfo *found = nullptr;
+    if (getaddrinfo(hostname, nullptr, &hints, &found) != 0 || !found)
+    {
+        return 0;
+    }
+    result = IPAddress((uint32_t)((struct sockaddr_in *)found->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(found);
+    return 1;
+}
+
+// Every simulated network is one access point on channel 6
+uint8_t *WiFiClass::BSSID()
+{
+    static uint8_t bssid[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    return currentStatus == WL_CONNECTED ? bssid : nullptr;
+}
+
+int32_t WiFiClass::channel()
+{
+    return currentStatus == WL_CONNECTED ? 6 : 0;
+}
+
+bool WiFiClass::config(IPAddress, IPAddress, IPAddress, IPAddress, IPAddress)
+{
+    return true;
+}
+
+bool WiFiClass::softAP(const char *, const char *, int, int, int)
+{
+    return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool)
+{
+    return true;
+}
+
+IPAddress WiFiClass::softAPIP()
+{
+    return IPAddress(192, 168, 4, 1);
+}
+
+// Scans finish instantly: an async scan is reported complete on the first poll
+int16_t WiFiClass::scanNetworks(bool async, bool, bool, uint32_t, uint8_t)
+{
+    scanState = NUM_SIMULATED_NETWORKS;
+    return async ? WIFI_SCAN_RUNNING : scanState;
+}
+
+int16_t WiFiClass::scanComplete()
+{
+    return scanState;
+}
+
+void WiFiClass::scanDelete()
+{
+    scanState = WIFI_SCAN_FAILED;
+}
+
+String WiFiClass::SSID(uint8_t index)
+{
+    return index < NUM_SIMULATED_NETWORKS ? String(SIMULATED_NETWORKS[index].ssid) : String();
+}
+
+int32_t WiFiClass::RSSI(uint8_t index)
+{
+    return index < NUM_SIMULATED_NETWORKS ? SIMULATED_NETWORKS[index].rssi : 0;
+}
+
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t index)
+{
+    return index < NUM_SIMULATED_NETWORKS ? SIMULATED_NETWORKS[index].encryption : WIFI_AUTH_OPEN;
+}
+
+void WiFiClass::simulateConnectFailure(bool fail)
+{
+    failConnect = fail;
+}
+
+void WiFiClass::simulateLinkLoss()
+{
+    if (currentStatus == WL_CONNECTED)
+    {
+        currentStatus = WL_CONNECTION_LOST;
+        fireEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+// Host stand-in for the ESP32 WiFi library: a fake radio with a fixed set of
+// visible networks that connects to any of them instantly.
+
+#include <Arduino.h>
+
+typedef enum
+{
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum
+{
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} wifi_mode_t;
+
+typedef enum
+{
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WEP,
+    WIFI_AUTH_WPA_PSK,
+    WIFI_AUTH_WPA2_PSK,
+    WIFI_AUTH_WPA_WPA2_PSK,
+    WIFI_AUTH_WPA2_ENTERPRISE,
+    WIFI_AUTH_WPA3_PSK
+} wifi_auth_mode_t;
+
+// Subset of the Arduino event ids; events fire synchronously from begin()/disconnect()
+typedef enum
+{
+    ARDUINO_EVENT_WIFI_STA_CONNECTED,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP,
+    ARDUINO_EVENT_WIFI_STA_LOST_IP
+} arduino_event_id_t;
+
+typedef void (*WiFiEventCb)(arduino_event_id_t event);
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+class WiFiClass
+{
+public:
+    WiFiClass();
+
+    bool mode(wifi_mode_t mode);
+    wifi_mode_t getMode();
+    bool setAutoReconnect(bool autoReconnect);
+    int onEvent(WiFiEventCb callback);
+
+    wl_status_t begin(const char *ssid, const char *passphrase = nullptr, int32_t channel = 0,
+                      const uint8_t *bssid = nullptr, bool connect = true);
+    bool disconnect(bool wifioff = false, bool eraseap = false);
+    wl_status_t status();
+
+    String SSID();
+    int32_t RSSI();
+    IPAddress localIP();
+    IPAddress gatewayIP();
+    IPAddress subnetMask();
+    IPAddress dnsIP(uint8_t dnsNumber = 0);
+    uint8_t *BSSID();
+    int32_t channel();
+    bool config(IPAddress localIP, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+    int hostByName(const char *hostname, IPAddress &result); // Real lookup through the host resolver
+
+    bool softAP(const char *ssid, const char *passphrase = nullptr, int channel = 1, int ssidHidden = 0, int maxConnection = 4);
+    bool softAPdisconnect(bool wifioff = false);
+    IPAddress softAPIP();
+
+    int16_t scanNetworks(bool async = false, bool showHidden = false, bool passive = false,
+                         uint32_t maxMsPerChannel = 300, uint8_t channel = 0);
+    int16_t scanComplete();
+    void scanDelete();
+    String SSID(uint8_t index);
+    int32_t RSSI(uint8_t index);
+    wifi_auth_mode_t encryptionType(uint8_t index);
+
+    // Host simulation: make the next begin() fail (e.g. wrong password, AP down)
+    void simulateConnectFailure(bool fail);
+    void simulateLinkLoss(); // Drop the connection as if the access point vanished
+
+private:
+    wifi_mode_t currentMode;
+    wl_status_t currentStatus;
+    String connectedSSID;
+    bool failConnect;
+    int16_t scanState;
+    static const int MAX_EVENT_CALLBACKS = 4;
+    WiFiEventCb eventCallbacks[MAX_EVENT_CALLBACKS];
+    int eventCallbackCount;
+
+    void fireEvent(arduino_event_id_t event);
+};
+
+extern WiFiClass WiFi;
+
+#endif
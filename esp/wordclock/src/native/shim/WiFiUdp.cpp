@@ -0,0 +1,116 @@
+#include "WiFiUdp.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+WiFiUDP::WiFiUDP() : fd(-1), txPort(0), txLength(0), rxLength(0), rxOffset(0), rxPort(0) {}
+
+WiFiUDP::~WiFiUDP()
+{
+    stop();
+}
+
+uint8_t WiFiUDP::begin(uint16_t port)
+{
+    stop();
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+        return 0;
+    }
+    struct sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr *)&local, sizeof(local)) < 0)
+    {
+        stop();
+        return 0;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return 1;
+}
+
+void WiFiUDP::stop()
+{
+    if (fd >= 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port)
+{
+    txAddress = ip;
+    txPort = port;
+    txLength = 0;
+    return fd >= 0 ? 1 : 0;
+}
+
+size_t WiFiUDP::write(const uint8_t *buffer, size_t size)
+{
+    if (size > MAX_DATAGRAM - txLength)
+    {
+        size = MAX_DATAGRAM - txLength;
+    }
+    memcpy(txBuffer + txLength, buffer, size);
+    txLength += size;
+    return size;
+}
+
+int WiFiUDP::endPacket()
+{
+    struct sockaddr_in remote = {};
+    remote.sin_family = AF_INET;
+    remote.sin_addr.s_addr = (uint32_t)txAddress; // IPAddress keeps network byte order
+    remote.sin_port = htons(txPort);
+    ssize_t sent = sendto(fd, txBuffer, txLength, 0, (struct sockaddr *)&remote, sizeof(remote));
+    txLength = 0;
+    return sent >= 0 ? 1 : 0;
+}
+
+int WiFiUDP::parsePacket()
+{
+    rxLength = 0;
+    rxOffset = 0;
+    if (fd < 0)
+    {
+        return 0;
+    }
+    struct sockaddr_in remote = {};
+    socklen_t remoteSize = sizeof(remote);
+    ssize_t received = recvfrom(fd, rxBuffer, sizeof(rxBuffer), 0, (struct sockaddr *)&remote, &remoteSize);
+    if (received <= 0)
+    {
+        return 0;
+    }
+    rxLength = received;
+    rxAddress = IPAddress((uint32_t)remote.sin_addr.s_addr);
+    rxPort = ntohs(remote.sin_port);
+    return (int)rxLength;
+}
+
+int WiFiUDP::read(uint8_t *buffer, size_t len)
+{
+    size_t available = rxLength - rxOffset;
+    if (len > available)
+    {
+        len = available;
+    }
+    memcpy(buffer, rxBuffer + rxOffset, len);
+    rxOffset += len;
+    return (int)len;
+}
+
+IPAddress WiFiUDP::remoteIP()
+{
+    return rxAddress;
+}
+
+uint16_t WiFiUDP::remotePort()
+{
+    return rxPort;
+}
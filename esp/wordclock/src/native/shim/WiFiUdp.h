@@ -0,0 +1,42 @@
+#ifndef NATIVE_WIFI_UDP_H
+#define NATIVE_WIFI_UDP_H
+
+// Host WiFiUDP on a real non-blocking POSIX socket, so the NTP client can talk
+// to servers on the LAN or to an ntpd on localhost.
+
+#include <Arduino.h>
+
+class WiFiUDP
+{
+public:
+    WiFiUDP();
+    ~WiFiUDP();
+
+    uint8_t begin(uint16_t port); // 1 on success, port 0 picks a free one
+    void stop();
+
+    int beginPacket(IPAddress ip, uint16_t port);
+    size_t write(const uint8_t *buffer, size_t size);
+    int endPacket(); // 1 when the datagram went out
+
+    int parsePacket(); // Size of the next datagram, 0 if none is waiting
+    int read(uint8_t *buffer, size_t len);
+    IPAddress remoteIP();
+    uint16_t remotePort();
+
+private:
+    static const size_t MAX_DATAGRAM = 1472;
+
+    int fd;
+    IPAddress txAddress;
+    uint16_t txPort;
+    uint8_t txBuffer[MAX_DATAGRAM];
+    size_t txLength;
+    uint8_t rxBuffer[MAX_DATAGRAM];
+    size_t rxLength;
+    size_t rxOffset;
+    IPAddress rxAddress;
+    uint16_t rxPort;
+};
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+// Defaults for host builds when src/config.h does not exist
+
+#define USE_SERIAL 1
+#define LED_PIN 13
+#define RESET_BUTTON_PIN 0
+#define DEFAULT_GMT_OFFSET_SEC 3600
+#define DEFAULT_DAYLIGHT_OFFSET_SEC 3600
+
+#endif
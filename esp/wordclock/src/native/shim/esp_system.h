@@ -0,0 +1,20 @@
+#ifndef NATIVE_ESP_SYSTEM_H
+#define NATIVE_ESP_SYSTEM_H
+
+#include <Arduino.h>
+
+typedef int esp_err_t;
+typedef void (*shutdown_handler_t)(void);
+
+inline void esp_restart()
+{
+    ESP.restart();
+}
+
+// Nothing to flush on the host, exit() skips the handlers
+inline esp_err_t esp_register_shutdown_handler(shutdown_handler_t)
+{
+    return 0;
+}
+
+#endif
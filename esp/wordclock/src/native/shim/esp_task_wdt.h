@@ -0,0 +1,12 @@
+#ifndef NATIVE_ESP_TASK_WDT_H
+#define NATIVE_ESP_TASK_WDT_H
+
+typedef int esp_err_t;
+
+// No watchdog on the host
+inline esp_err_t esp_task_wdt_reset()
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef NATIVE_LWIP_DNS_H
+#define NATIVE_LWIP_DNS_H
+
+// Host stand-in for the lwIP resolver: every lookup goes through getaddrinfo
+// on a thread of its own and calls back from there, like the lwIP thread would.
+
+#include "lwip/err.h"
+
+typedef struct ip4_addr
+{
+    uint32_t addr; // Network byte order
+} ip4_addr_t;
+
+typedef struct ip_addr
+{
+    union
+    {
+        ip4_addr_t ip4;
+    } u_addr;
+    uint8_t type;
+} ip_addr_t;
+
+#define IPADDR_TYPE_V4 0
+#define IP_IS_V4(ipaddr) ((ipaddr)->type == IPADDR_TYPE_V4)
+#define ip_2_ip4(ipaddr) (&((ipaddr)->u_addr.ip4))
+
+typedef void (*dns_found_callback)(const char *name, const ip_addr_t *ipaddr, void *callback_arg);
+
+// Always ERR_INPROGRESS: found is called later with nullptr when the name does not resolve
+err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *callback_arg);
+
+#endif
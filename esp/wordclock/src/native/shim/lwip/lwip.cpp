@@ -0,0 +1,39 @@
+#include "lwip/dns.h"
+#include "lwip/tcpip.h"
+#include <netdb.h>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+
+err_t dns_gethostbyname(const char *hostname, ip_addr_t *, dns_found_callback found, void *callback_arg)
+{
+    if (!hostname || !found)
+    {
+        return ERR_ARG;
+    }
+    std::string name = hostname; // lwIP keeps its own copy as well
+    std::thread([name, found, callback_arg] {
+        struct addrinfo hints = {};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+        struct addrinfo *result = nullptr;
+        if (getaddrinfo(name.c_str(), nullptr, &hints, &result) != 0 || !result)
+        {
+            found(name.c_str(), nullptr, callback_arg);
+            return;
+        }
+        ip_addr_t address = {};
+        address.type = IPADDR_TYPE_V4;
+        address.u_addr.ip4.addr = ((struct sockaddr_in *)result->ai_addr)->sin_addr.s_addr;
+        freeaddrinfo(result);
+        found(name.c_str(), &address, callback_arg);
+    }).detach();
+    return ERR_INPROGRESS;
+}
+
+err_t tcpip_callback(tcpip_callback_fn function, void *ctx)
+{
+    function(ctx);
+    return ERR_OK;
+}
@@ -0,0 +1,11 @@
+#ifndef NATIVE_LWIP_TCPIP_H
+#define NATIVE_LWIP_TCPIP_H
+
+#include "lwip/err.h"
+
+typedef void (*tcpip_callback_fn)(void *ctx);
+
+// There is no lwIP thread on the host, the function runs right away
+err_t tcpip_callback(tcpip_callback_fn function, void *ctx);
+
+#endif
@@ -2,6 +2,8 @@ from PIL import Image
 import time
 from clock_display_hal import ClockDisplayHAL
 
+SCALE_MODES = ("stretch", "letterbox", "crop")
+
 
 def update_led_pixels(gif_pixels, new_size, clock_display_hal):
     for y in range(new_size[1]):
@@ -10,28 +12,61 @@ def update_led_pixels(gif_pixels, new_size, clock_display_hal):
             clock_display_hal.set_pixel(x, y, (r, g, b))
 
 
-def display_gif(gif_path, clock_display_hal, display_gif_duration=4, background_color=(0, 0, 0)):
+def scale_frame(frame, new_size, scale_mode="letterbox"):
+    """Area-averages an RGBA frame to new_size; letterbox bars are transparent."""
+    width, height = frame.size
+    wider = width * new_size[1] > height * new_size[0]
+    if scale_mode == "crop":
+        # Centre cut with the display's aspect ratio
+        if wider:
+            crop_width = max(1, round(height * new_size[0] / new_size[1]))
+            left = (width - crop_width) // 2
+            frame = frame.crop((left, 0, left + crop_width, height))
+        else:
+            crop_height = max(1, round(width * new_size[1] / new_size[0]))
+            top = (height - crop_height) // 2
+            frame = frame.crop((0, top, width, top + crop_height))
+    elif scale_mode == "letterbox":
+        if wider:
+            fitted = (new_size[0], max(1, round(height * new_size[0] / width)))
+        else:
+            fitted = (max(1, round(width * new_size[1] / height)), new_size[1])
+        canvas = Image.new("RGBA", new_size, (0, 0, 0, 0))
+        canvas.paste(frame.resize(fitted, Image.BOX),
+                     ((new_size[0] - fitted[0]) // 2, (new_size[1] - fitted[1]) // 2))
+        return canvas
+    return frame.resize(new_size, Image.BOX)
+
+
+def load_gif(gif_path, scale_mode="letterbox", background_color=(0, 0, 0)):
+    """Decodes and scales every frame once; returns [(pixels, seconds), ...]."""
     img = Image.open(gif_path)
     new_size = (ClockDisplayHAL.WIDTH, ClockDisplayHAL.HEIGHT)
+    frames = []
+    for index in range(getattr(img, "n_frames", 1)):
+        img.seek(index)
+        frame = scale_frame(img.convert("RGBA"), new_size, scale_mode)
+        gif_pixels = frame.load()
+        pixels = []
+        for y in range(new_size[1]):
+            for x in range(new_size[0]):
+                r, g, b, a = gif_pixels[x, y]
+                pixels.append((r, g, b) if a > 0 else background_color)
+        # Frames asking for under 20 ms get 100 ms, like browsers do
+        duration = img.info.get("duration", 0)
+        frames.append((pixels, duration / 1000 if duration >= 20 else 0.1))
+    return frames
+
+
+def display_gif(frames, clock_display_hal, display_gif_duration=4):
+    width = ClockDisplayHAL.WIDTH
     start_time = time.time()
+    index = 0
 
-    while time.time() < start_time + display_gif_duration:
-        try:
-            frame = img.convert("RGBA")
-            frame = frame.resize(new_size)
-            gif_pixels = frame.load()
-
-            for y in range(new_size[1]):
-                for x in range(new_size[0]):
-                    r, g, b, a = gif_pixels[x, y]
-                    if a > 0:
-                        clock_display_hal.set_pixel(x, y, (r, g, b))
-                    else:
-                        clock_display_hal.set_pixel(x, y, background_color)
-
-            clock_display_hal.show()
-            time.sleep(0.1)
-            img.seek(img.tell() + 1)
-
-        except EOFError:
-            img.seek(0)
+    while frames and time.time() < start_time + display_gif_duration:
+        pixels, delay = frames[index]
+        for i, color in enumerate(pixels):
+            clock_display_hal.set_pixel(i % width, i // width, color)
+        clock_display_hal.show()
+        time.sleep(delay)
+        index = (index + 1) % len(frames)
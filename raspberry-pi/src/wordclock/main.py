@@ -2,14 +2,15 @@ import argparse
 import time
 from clock_display_hal import ClockDisplayHAL
 from word_clock import WordClock
+from gif import SCALE_MODES
 
 
 # Color definitions
 
 
-def main(pin, brightness, gif_path):
+def main(pin, brightness, gif_path, gif_scale):
     clock_display_hal = ClockDisplayHAL(pin, brightness)
-    word_clock = WordClock(clock_display_hal, gif_path)
+    word_clock = WordClock(clock_display_hal, gif_path, gif_scale)
 
     try:
         while True:
@@ -27,5 +28,7 @@ if __name__ == "__main__":
                         required=False, help="The brightness of the clock display.",
                         default=0.05)
     parser.add_argument("--gif", type=str, required=False, help="The path to the GIF image.")
+    parser.add_argument("--gif-scale", type=str, required=False, choices=SCALE_MODES, default="letterbox",
+                        help="How a GIF of another size is fitted to the display.")
     args = parser.parse_args()
-    main(args.pin, args.brightness, args.gif)
+    main(args.pin, args.brightness, args.gif, args.gif_scale)
@@ -1,6 +1,6 @@
 import random
 from datetime import datetime
-from gif import display_gif
+from gif import display_gif, load_gif
 from clock_display_hal import ClockDisplayHAL
 
 
@@ -16,11 +16,13 @@ class WordClock:
         (165, 42, 42),  # Brown
     ]
 
-    def __init__(self, clock_display_hal,gif_path):
+    def __init__(self, clock_display_hal, gif_path, gif_scale="letterbox"):
         self.last_hour = -1
         self.all_last_highlighted_words = ""
         self.clock_display_hal = clock_display_hal
-        self.gif_path=gif_path
+        self.gif_path = gif_path
+        # Decoded and scaled once, not on every pass through the animation
+        self.gif_frames = load_gif(gif_path, gif_scale) if gif_path else None
 
     def highlight_word(self, word, color=(255, 255, 255)):
         if word in ClockDisplayHAL.WORDS_TO_LEDS:
@@ -62,7 +64,7 @@ class WordClock:
         self.clock_display_hal.clear_pixels(show=False)
         if hour != self.last_hour and self.gif_path:
             if minute == 0:
-                display_gif(self.gif_path,self.clock_display_hal)
+                display_gif(self.gif_frames, self.clock_display_hal)
                 self.clock_display_hal.clear_pixels(show=False)
                 self.last_hour = hour
 